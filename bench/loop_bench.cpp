@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+// Headless frame loop: the per frame pose work of main.cpp and SenderThread to a loopback FrameSink, no SDL or GPU
+
+#include "fixed_step.h"
+#include "frame_sink.h"
+#include "latency_histogram.h"
+#include "math_helper.h"
+#include "period_recorder.h"
+#include "sender_thread.h"
+#include "tx_timestamps.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+/* What Movement::updatePose does with a constant input: Euler round trip, then a step along the view */
+static void movePose(xrt_pose& pose, float yaw_step, float walk_step) {
+    auto [yaw, pitch, roll] = quatToYXZ(pose.orientation);
+    pose.orientation = quatFromYXZ(yaw + yaw_step, pitch, roll);
+    pose.position = pose.position + quatMultVec(pose.orientation, {0.0f, 0.0f, -walk_step});
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [-r loop_hz] [-m sim_hz] [-s send_hz] [-d seconds] [--json path]\n", name);
+    printf("  -r  frame loop rate, default 90 (a vsync stand-in)\n");
+    printf("  -m  movement simulation rate, default %d like the GUI\n", Config{}.sim_rate);
+    printf("  -s  SenderThread rate, default 500\n");
+    printf("  -d  duration, default 3 s\n");
+}
+
+int main(int argc, char** argv) {
+    int loop_hz = 90;
+    int sim_hz = Config{}.sim_rate;
+    int send_hz = 500;
+    int seconds = 3;
+    std::string json;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-r" && i + 1 < argc) {
+            loop_hz = std::atoi(argv[++i]);
+        } else if (arg == "-m" && i + 1 < argc) {
+            sim_hz = std::atoi(argv[++i]);
+        } else if (arg == "-s" && i + 1 < argc) {
+            send_hz = std::atoi(argv[++i]);
+        } else if (arg == "-d" && i + 1 < argc) {
+            seconds = std::atoi(argv[++i]);
+        } else if (arg == "--json" && i + 1 < argc) {
+            json = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (loop_hz <= 0 || sim_hz <= 0 || send_hz <= 0 || seconds <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FrameSink sink;
+    if (sink.listen("127.0.0.1:0") < 0) {
+        return 1;
+    }
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool> stop{false};
+    sink.setFrameCallback([&](uint64_t, const r_remote_data&, uint64_t) { received++; });
+    std::thread receiver([&] {
+        while (!stop) {
+            sink.poll(10);
+        }
+    });
+
+    PeriodRecorder loop;
+    PeriodRecorder send;
+    loop.reserve(static_cast<size_t>(seconds) * loop_hz + 16);
+    send.reserve(static_cast<size_t>(seconds) * send_hz + 1000);
+    LatencyHistogram work; // ns of pose math and publish() per frame
+
+    SenderThread sender;
+    sender.start(send_hz);
+    sender.requestConnect("127.0.0.1:" + std::to_string(sink.getPort()));
+    uint64_t deadline = monotonicNs() + 5000000000ULL;
+    while (!sender.isConnected() && monotonicNs() < deadline) {
+        usleep(1000);
+    }
+    if (!sender.isConnected()) {
+        std::cerr << "Cannot connect to the loopback sink" << std::endl;
+        stop = true;
+        receiver.join();
+        return 1;
+    }
+    sender.setSendRecorder(&send);
+
+    r_remote_data data{};
+    data.header = R_HEADER_VALUE;
+    data.head.center.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
+    data.head.center.position = {0.0f, 1.7f, 1.0f};
+    xrt_pose left_rel = {{0.0f, 0.0f, 0.0f, 1.0f}, {-0.3f, -0.3f, -0.4f}};
+    xrt_pose right_rel = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.3f, -0.3f, -0.4f}};
+    data.left.active = true;
+    data.right.active = true;
+    // the last two simulation steps, like step_head/step_left/step_right in main.cpp
+    xrt_pose step_head[2] = {data.head.center, data.head.center};
+    xrt_pose step_left[2] = {poseMult(data.head.center, left_rel), poseMult(data.head.center, left_rel)};
+    xrt_pose step_right[2] = {poseMult(data.head.center, right_rel), poseMult(data.head.center, right_rel)};
+    FixedStep fixedStep;
+    fixedStep.setRate(sim_hz);
+    const float dt = static_cast<float>(fixedStep.getStepNs() / 1e9);
+    fixedStep.advance(monotonicNs());
+
+    timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    const int frames = seconds * loop_hz;
+    for (int i = 0; i < frames; i++) {
+        loop.mark();
+        uint64_t t0 = monotonicNs();
+        int steps = fixedStep.advance(t0);
+        for (int j = 0; j < steps; j++) {
+            step_head[0] = step_head[1];
+            step_left[0] = step_left[1];
+            step_right[0] = step_right[1];
+            movePose(step_head[1], 0.5f * dt, 1.0f * dt);
+            movePose(left_rel, 0.2f * dt, 0.0f);
+            step_left[1] = poseMult(step_head[1], left_rel);
+            movePose(right_rel, -0.2f * dt, 0.0f);
+            step_right[1] = poseMult(step_head[1], right_rel);
+        }
+        if (steps > 0) {
+            data.left.angular_velocity = calculateAngularVel(step_left[0].orientation, step_left[1].orientation, dt);
+            data.right.angular_velocity = calculateAngularVel(step_right[0].orientation, step_right[1].orientation, dt);
+        }
+        float alpha = fixedStep.getAlpha();
+        data.head.center = poseInterpolate(step_head[0], step_head[1], alpha);
+        data.left.pose = poseInterpolate(step_left[0], step_left[1], alpha);
+        data.right.pose = poseInterpolate(step_right[0], step_right[1], alpha);
+        sender.publish(data);
+        work.record(monotonicNs() - t0);
+
+        next.tv_nsec += 1000000000L / loop_hz;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+    }
+    sender.stop();
+    sender.setSendRecorder(nullptr);
+    stop = true;
+    receiver.join();
+
+    PeriodSummary l = loop.getSummary(1000000000ULL / loop_hz);
+    PeriodSummary s = send.getSummary(1000000000ULL / send_hz);
+    double work_mean_us = work.getMean() / 1000.0;
+    double work_p99_us = work.getPercentile(99.0) / 1000.0;
+    printf("%d s, frame loop at %d Hz, simulation at %d Hz, SenderThread at %d Hz, %llu frames received\n", seconds,
+           loop_hz, sim_hz, send_hz, (unsigned long long)received.load());
+    printf("frame work (simulation steps, interpolation, publish): mean %.2f us, p99 %.2f us, max %.2f us\n", work_mean_us, work_p99_us, work.getMax() / 1000.0);
+    printf("loop period: deviation p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n", l.dev_p50_us,
+           l.dev_p99_us, l.dev_p999_us, l.dev_max_us);
+    printf("send period: deviation p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n", s.dev_p50_us,
+           s.dev_p99_us, s.dev_p999_us, s.dev_max_us);
+
+    if (!json.empty()) {
+        std::ofstream out(json);
+        if (!out) {
+            std::cerr << "Cannot write " << json << std::endl;
+            return 1;
+        }
+        auto period = [&out](const char* name, const PeriodSummary& p) {
+            out << "    {\"name\": \"" << name << "\", \"periods\": " << p.count << ", \"dev_p50_us\": " << p.dev_p50_us
+                << ", \"dev_p99_us\": " << p.dev_p99_us << ", \"dev_p999_us\": " << p.dev_p999_us
+                << ", \"dev_max_us\": " << p.dev_max_us << "}";
+        };
+        out << "{\n  \"benchmark\": \"loop\",\n  \"cases\": [\n";
+        out << "    {\"name\": \"frame\", \"frames\": " << work.getCount() << ", \"received\": " << received
+            << ", \"work_mean_us\": " << work_mean_us << ", \"work_p99_us\": " << work_p99_us << "},\n";
+        period("loop", l);
+        out << ",\n";
+        period("send", s);
+        out << "\n  ]\n}\n";
+        if (!out) {
+            return 1;
+        }
+    }
+    return 0;
+}
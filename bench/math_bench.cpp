@@ -0,0 +1,266 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+// Microbenchmarks of the math_helper pose functions on randomized inputs, hardware counters when perf allows it
+
+#include "math_helper.h"
+#include "tx_timestamps.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <linux/perf_event.h>
+#include <random>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+// inputs are cycled through, big enough to defeat branch history, small enough to stay in L1/L2
+static constexpr size_t input_count = 4096;
+static constexpr int repetitions = 7;
+
+template <typename T> static void doNotOptimize(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+/* cycles, instructions and cache misses of the calling thread in user space, one group read at once */
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+    bool isAvailable() const;
+    void start();
+    void stop(uint64_t (&values)[3]);
+private:
+    int fds[3];
+};
+
+PerfCounters::PerfCounters() {
+    const uint64_t configs[3] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < 3; i++) {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[i];
+        attr.disabled = i == 0;
+        attr.exclude_kernel = 1; // allowed with the default perf_event_paranoid
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0));
+        if (fds[i] < 0) {
+            // containers and VMs often have no PMU, the timings are still valid
+            for (int j = 0; j <= i; j++) {
+                if (fds[j] >= 0) {
+                    close(fds[j]);
+                }
+                fds[j] = -1;
+            }
+            std::cerr << "Hardware counters unavailable: " << strerror(errno) << std::endl;
+            return;
+        }
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+bool PerfCounters::isAvailable() const {
+    return fds[0] >= 0;
+}
+
+void PerfCounters::start() {
+    if (isAvailable()) {
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+void PerfCounters::stop(uint64_t (&values)[3]) {
+    uint64_t group[4] = {}; // nr followed by the values
+    if (isAvailable()) {
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (read(fds[0], group, sizeof(group)) != sizeof(group)) {
+            group[1] = group[2] = group[3] = 0;
+        }
+    }
+    values[0] = group[1];
+    values[1] = group[2];
+    values[2] = group[3];
+}
+
+struct Inputs {
+    std::vector<float> yaw, pitch, roll;
+    std::vector<xrt_quat> quats;
+    std::vector<xrt_vec3> vecs;
+    std::vector<xrt_pose> poses;
+};
+
+static xrt_quat randomQuat(std::mt19937& rng) {
+    // uniform on the unit sphere in 4D, the sign of w is left random like real tracker data
+    std::normal_distribution<float> n(0.0f, 1.0f);
+    float x = n(rng), y = n(rng), z = n(rng), w = n(rng);
+    float len = std::sqrt(x * x + y * y + z * z + w * w);
+    return {x / len, y / len, z / len, w / len};
+}
+
+static void makeInputs(Inputs& in, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> full(-M_PI, M_PI);
+    std::uniform_real_distribution<float> half(-M_PI_2, M_PI_2);
+    std::uniform_real_distribution<float> pos(-2.0f, 2.0f);
+    for (size_t i = 0; i < input_count; i++) {
+        in.yaw.push_back(full(rng));
+        in.pitch.push_back(half(rng));
+        in.roll.push_back(full(rng));
+        in.quats.push_back(randomQuat(rng));
+        in.vecs.push_back({pos(rng), pos(rng), pos(rng)});
+        in.poses.push_back({randomQuat(rng), {pos(rng), pos(rng), pos(rng)}});
+    }
+}
+
+struct KernelResult {
+    std::string name;
+    double ns_per_op = 0.0; // median of the repetitions
+    double min_ns_per_op = 0.0;
+    double cycles = -1.0; // per op, negative when the counters are unavailable
+    double instructions = -1.0;
+    double cache_misses = -1.0;
+};
+
+/* body(i) runs one operation on input i % input_count, a template so the call itself is not measured */
+template <typename Body> static KernelResult runKernel(const char* name, uint64_t ops, PerfCounters& perf, Body body) {
+    KernelResult result;
+    result.name = name;
+    for (size_t i = 0; i < input_count; i++) {
+        body(i); // warm up caches and the branch predictor
+    }
+    std::vector<double> times;
+    uint64_t best[3] = {};
+    for (int r = 0; r < repetitions; r++) {
+        uint64_t counters[3];
+        perf.start();
+        uint64_t t0 = monotonicNs();
+        for (uint64_t i = 0; i < ops; i++) {
+            body(i & (input_count - 1));
+        }
+        uint64_t t = monotonicNs() - t0;
+        perf.stop(counters);
+        times.push_back(static_cast<double>(t) / ops);
+        if (r == 0 || counters[0] < best[0]) {
+            std::copy(counters, counters + 3, best);
+        }
+    }
+    std::sort(times.begin(), times.end());
+    result.ns_per_op = times[times.size() / 2];
+    result.min_ns_per_op = times.front();
+    if (perf.isAvailable()) {
+        result.cycles = static_cast<double>(best[0]) / ops;
+        result.instructions = static_cast<double>(best[1]) / ops;
+        result.cache_misses = static_cast<double>(best[2]) / ops;
+    }
+    return result;
+}
+
+static void printResult(const KernelResult& r) {
+    printf("%-20s %9.2f %9.2f %10.1f", r.name.c_str(), r.ns_per_op, r.min_ns_per_op, 1e3 / r.ns_per_op);
+    if (r.cycles >= 0.0) {
+        printf(" %9.1f %9.1f %6.2f %9.4f\n", r.cycles, r.instructions, r.instructions / r.cycles, r.cache_misses);
+    } else {
+        printf(" %9s %9s %6s %9s\n", "n/a", "n/a", "n/a", "n/a");
+    }
+}
+
+static int writeJson(const std::string& path, unsigned seed, const std::vector<KernelResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return -1;
+    }
+    out << "{\n  \"benchmark\": \"math\",\n  \"seed\": " << seed << ",\n  \"cases\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const KernelResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"ns_per_op\": " << r.ns_per_op
+            << ", \"min_ns_per_op\": " << r.min_ns_per_op << ", \"mops_per_s\": " << 1e3 / r.ns_per_op;
+        if (r.cycles >= 0.0) {
+            out << ", \"cycles_per_op\": " << r.cycles << ", \"instructions_per_op\": " << r.instructions
+                << ", \"cache_misses_per_op\": " << r.cache_misses;
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out ? 0 : -1;
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [-n ops] [-s seed] [-f filter] [--json path]\n", name);
+    printf("  -n  operations per repetition, default 2000000\n");
+    printf("  -s  seed of the random inputs, default 1\n");
+    printf("  -f  run only the kernels whose name contains filter\n");
+}
+
+int main(int argc, char** argv) {
+    uint64_t ops = 2000000;
+    unsigned seed = 1;
+    std::string filter;
+    std::string json;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            ops = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "-s" && i + 1 < argc) {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "-f" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            json = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (ops == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Inputs in;
+    makeInputs(in, seed);
+    PerfCounters perf;
+
+    std::vector<KernelResult> results;
+    auto run = [&](const char* name, auto body) {
+        if (filter.empty() || std::string(name).find(filter) != std::string::npos) {
+            results.push_back(runKernel(name, ops, perf, body));
+            printResult(results.back());
+        }
+    };
+    printf("%llu ops x %d repetitions over %zu random inputs (seed %u), counters are per op in user space\n",
+           (unsigned long long)ops, repetitions, input_count, seed);
+    printf("%-20s %9s %9s %10s %9s %9s %6s %9s\n", "kernel", "ns/op", "min ns", "Mops/s", "cycles", "instr",
+           "IPC", "LLC miss");
+    // every result feeds doNotOptimize, the calls cannot be hoisted or dropped
+    run("quatFromYXZ", [&](size_t i) { doNotOptimize(quatFromYXZ(in.yaw[i], in.pitch[i], in.roll[i])); });
+    run("quatToYXZ", [&](size_t i) { doNotOptimize(quatToYXZ(in.quats[i])); });
+    run("quatMultVec", [&](size_t i) { doNotOptimize(quatMultVec(in.quats[i], in.vecs[i])); });
+    run("poseMult", [&](size_t i) { doNotOptimize(poseMult(in.poses[i], in.poses[(i + 1) & (input_count - 1)])); });
+    run("calculateAngularVel", [&](size_t i) {
+        doNotOptimize(calculateAngularVel(in.quats[i], in.quats[(i + 1) & (input_count - 1)], 0.002f));
+    });
+    if (!json.empty() && writeJson(json, seed, results) < 0) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,246 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+// Soak test of Movement on a virtual clock: hours of frames in seconds, drift against an analytic reference
+
+#include "fixed_step.h"
+#include "movement.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Euler angles of the walker's orientation that the input never changes, so the round trip is exercised off axis
+static const double start_pitch = 0.2;
+static const double start_roll = 0.1;
+static const double start_yaw = 0.0;
+
+struct SoakSample {
+    double hours = 0.0;
+    double walk_norm_error = 0.0; // |1 - |q||
+    double walk_angle_error_deg = 0.0; // angle between the pose and the reference orientation
+    double walk_position_error_mm = 0.0;
+    double walk_distance_m = 0.0; // distance of the reference from the origin
+    double idle_norm_error = 0.0;
+    double idle_angle_error_deg = 0.0;
+    double idle_position_error_mm = 0.0;
+    long rss_kib = 0;
+};
+
+static long residentKiB(void) {
+    long pages = 0;
+    long resident = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+        if (fscanf(statm, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(statm);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+struct QuatD {
+    double x, y, z, w;
+};
+
+static QuatD quatMultD(const QuatD& a, const QuatD& b) {
+    return {a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y, a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w, a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+
+/* Same convention as glm::eulerAngleYXZ: R = Ry(yaw) * Rx(pitch) * Rz(roll) */
+static QuatD quatFromYXZd(double yaw, double pitch, double roll) {
+    QuatD qy = {0.0, std::sin(yaw / 2), 0.0, std::cos(yaw / 2)};
+    QuatD qx = {std::sin(pitch / 2), 0.0, 0.0, std::cos(pitch / 2)};
+    QuatD qz = {0.0, 0.0, std::sin(roll / 2), std::cos(roll / 2)};
+    return quatMultD(quatMultD(qy, qx), qz);
+}
+
+static double quatNormError(const xrt_quat& q) {
+    double norm = std::sqrt(static_cast<double>(q.x) * q.x + static_cast<double>(q.y) * q.y
+                            + static_cast<double>(q.z) * q.z + static_cast<double>(q.w) * q.w);
+    return std::fabs(1.0 - norm);
+}
+
+static double angleErrorDeg(const xrt_quat& q, const QuatD& ref) {
+    double norm = std::sqrt(static_cast<double>(q.x) * q.x + static_cast<double>(q.y) * q.y
+                            + static_cast<double>(q.z) * q.z + static_cast<double>(q.w) * q.w);
+    double dot = std::fabs(q.x * ref.x + q.y * ref.y + q.z * ref.z + q.w * ref.w) / norm;
+    return 2.0 * std::acos(std::min(dot, 1.0)) * 180.0 / M_PI;
+}
+
+static double distanceMm(const xrt_vec3& p, double x, double y, double z) {
+    return std::sqrt((p.x - x) * (p.x - x) + (p.y - y) * (p.y - y) + (p.z - z) * (p.z - z)) * 1000.0;
+}
+
+static int writeJson(const std::string& path, int frame_ms, int sim_hz, const std::vector<SoakSample>& samples) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return -1;
+    }
+    out << "{\n  \"benchmark\": \"movement_soak\",\n  \"frame_ms\": " << frame_ms << ",\n  \"sim_hz\": " << sim_hz
+        << ",\n  \"samples\": [\n";
+    for (size_t i = 0; i < samples.size(); i++) {
+        const SoakSample& s = samples[i];
+        out << "    {\"hours\": " << s.hours << ", \"walk_norm_error\": " << s.walk_norm_error
+            << ", \"walk_angle_error_deg\": " << s.walk_angle_error_deg
+            << ", \"walk_position_error_mm\": " << s.walk_position_error_mm
+            << ", \"walk_distance_m\": " << s.walk_distance_m << ", \"idle_norm_error\": " << s.idle_norm_error
+            << ", \"idle_angle_error_deg\": " << s.idle_angle_error_deg
+            << ", \"idle_position_error_mm\": " << s.idle_position_error_mm << ", \"rss_kib\": " << s.rss_kib << "}"
+            << (i + 1 < samples.size() ? "," : "") << "\n";
+    }
+    // the last row as cases, the drift the perf gate compares
+    const SoakSample& last = samples.back();
+    out << "  ],\n  \"cases\": [\n";
+    out << "    {\"name\": \"walk\", \"norm_error\": " << last.walk_norm_error
+        << ", \"angle_error_deg\": " << last.walk_angle_error_deg
+        << ", \"position_error_mm\": " << last.walk_position_error_mm << "},\n";
+    out << "    {\"name\": \"idle\", \"norm_error\": " << last.idle_norm_error
+        << ", \"angle_error_deg\": " << last.idle_angle_error_deg
+        << ", \"position_error_mm\": " << last.idle_position_error_mm << "}\n";
+    out << "  ]\n}\n";
+    return out ? 0 : -1;
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [-H hours] [-f frame_ms] [-m sim_hz] [-i report_minutes] [--json path]\n", name);
+    printf("  -H  simulated hours, default 8\n");
+    printf("  -f  virtual frame time in ms, default 11 (90 Hz)\n");
+    printf("  -m  movement simulation rate, default %d like the GUI\n", Config{}.sim_rate);
+    printf("  -i  simulated minutes between report rows, default 30\n");
+}
+
+int main(int argc, char** argv) {
+    double hours = 8.0;
+    int frame_ms = 11;
+    int sim_hz = Config{}.sim_rate;
+    double report_minutes = 30.0;
+    std::string json;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-H" && i + 1 < argc) {
+            hours = std::atof(argv[++i]);
+        } else if (arg == "-f" && i + 1 < argc) {
+            frame_ms = std::atoi(argv[++i]);
+        } else if (arg == "-m" && i + 1 < argc) {
+            sim_hz = std::atoi(argv[++i]);
+        } else if (arg == "-i" && i + 1 < argc) {
+            report_minutes = std::atof(argv[++i]);
+        } else if (arg == "--json" && i + 1 < argc) {
+            json = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (hours <= 0.0 || frame_ms <= 0 || sim_hz <= 0 || report_minutes <= 0.0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // walker: W held and a constant mouse yaw, it walks a circle and climbs with the pitch forever
+    const float lin_v = 1.0f; // m/s
+    const float ang_v = 0.5f; // rad/s with the mouse moving one count per 60 Hz frame
+    FixedStep fixedStep;
+    fixedStep.setRate(sim_hz);
+    Movement walker;
+    walker.updateConfigValues(lin_v, ang_v, 1.0f, 1.0f, 0.1f);
+    walker.setFixedStep(fixedStep.getStepNs());
+    SDL_Event key{};
+    key.type = SDL_EVENT_KEY_DOWN;
+    key.key.key = SDLK_W;
+    key.key.down = true;
+    walker.passKeyboardEvent(key);
+    // idle: no input at all, like a controller nobody touches, the pose must not move
+    Movement idle;
+    idle.updateConfigValues(lin_v, ang_v, 1.0f, 1.0f, 0.1f);
+    idle.setFixedStep(fixedStep.getStepNs());
+
+    xrt_pose walk_pose;
+    QuatD start = quatFromYXZd(start_yaw, start_pitch, start_roll);
+    walk_pose.orientation = {static_cast<float>(start.x), static_cast<float>(start.y), static_cast<float>(start.z),
+                             static_cast<float>(start.w)};
+    walk_pose.position = {0.0f, 1.7f, 1.0f};
+    xrt_pose idle_pose = walk_pose;
+    idle_pose.position = {-0.3f, -0.3f, -0.4f};
+    const xrt_pose idle_start = idle_pose;
+
+    // per simulation step increments as Movement computes them, in double for the reference; with a frame time
+    // that is not a multiple of the step, the mouse share of a step varies and adds an error below one step
+    const double step_ms = fixedStep.getStepNs() / 1e6;
+    const double step = static_cast<double>(lin_v) / 1000.0 * step_ms; // m
+    const double theta = static_cast<double>(ang_v) / 1000.0 * step_ms; // rad, positive: mouse x is negated
+    const float mouse_x = -frame_ms / mouse_frame_ms; // the constant yaw rate of ang_v
+    const uint64_t frames = static_cast<uint64_t>(hours * 3600000.0 / frame_ms);
+    const uint64_t report_every = std::max<uint64_t>(1, static_cast<uint64_t>(report_minutes * 60000.0 / frame_ms));
+
+    std::vector<SoakSample> samples;
+    samples.reserve(frames / report_every + 2);
+    uint64_t last_reported = 0; // frame of the last row
+    printf("%.1f h of %d ms frames (%llu frames) at %d Hz simulation, W held with a constant yaw rate, pitch %.2f, "
+           "roll %.2f rad\n", hours, frame_ms, (unsigned long long)frames, sim_hz, start_pitch, start_roll);
+    printf("%8s %12s %12s %14s %12s %12s %12s %12s %10s\n", "hours", "walk |q|-1", "walk deg", "walk pos mm",
+           "distance m", "idle |q|-1", "idle deg", "idle pos mm", "RSS KiB");
+
+    Uint64 ticks_ns = 1000000000ULL;
+    fixedStep.advance(ticks_ns); // starts the clock, the first frame below already moves
+    uint64_t n = 0; // simulation steps so far
+    for (uint64_t f = 1; f <= frames; f++) {
+        ticks_ns += frame_ms * 1000000ULL;
+        int steps = fixedStep.advance(ticks_ns);
+        walker.passMouseRelativePos(mouse_x, 0.0f);
+        walker.beginSteps(steps);
+        idle.passMouseRelativePos(0.0f, 0.0f);
+        idle.beginSteps(steps);
+        for (int i = 0; i < steps; i++) {
+            walker.updatePose(walk_pose);
+            idle.updatePose(idle_pose);
+        }
+        n += steps;
+        // the end gets its own row unless the last one is less than a tenth of the interval back
+        bool final_row = f == frames && (last_reported == 0 || f - last_reported >= report_every / 10 + 1);
+        if (f % report_every != 0 && !final_row) {
+            continue;
+        }
+        last_reported = f;
+        // closed form of the steps: yaw_k = k * theta, delta_k = Ry(yaw_k) * Rx(pitch) * (0, 0, -step)
+        double yaw = start_yaw + n * theta;
+        double sum_sin = std::sin(start_yaw + (n + 1) * theta / 2) * std::sin(n * theta / 2) / std::sin(theta / 2);
+        double sum_cos = std::cos(start_yaw + (n + 1) * theta / 2) * std::sin(n * theta / 2) / std::sin(theta / 2);
+        double ref_x = 0.0 - step * std::cos(start_pitch) * sum_sin;
+        double ref_y = 1.7 + n * step * std::sin(start_pitch);
+        double ref_z = 1.0 - step * std::cos(start_pitch) * sum_cos;
+        SoakSample s;
+        s.hours = static_cast<double>(f) * frame_ms / 3600000.0;
+        s.walk_norm_error = quatNormError(walk_pose.orientation);
+        s.walk_angle_error_deg = angleErrorDeg(walk_pose.orientation, quatFromYXZd(yaw, start_pitch, start_roll));
+        s.walk_position_error_mm = distanceMm(walk_pose.position, ref_x, ref_y, ref_z);
+        s.walk_distance_m = std::sqrt(ref_x * ref_x + ref_y * ref_y + ref_z * ref_z);
+        s.idle_norm_error = quatNormError(idle_pose.orientation);
+        s.idle_angle_error_deg = angleErrorDeg(idle_pose.orientation, start);
+        s.idle_position_error_mm = distanceMm(idle_pose.position, idle_start.position.x, idle_start.position.y,
+                                              idle_start.position.z);
+        s.rss_kib = residentKiB();
+        samples.push_back(s);
+        printf("%8.2f %12.3e %12.6f %14.3f %12.1f %12.3e %12.6f %12.3f %10ld\n", s.hours, s.walk_norm_error,
+               s.walk_angle_error_deg, s.walk_position_error_mm, s.walk_distance_m, s.idle_norm_error,
+               s.idle_angle_error_deg, s.idle_position_error_mm, s.rss_kib);
+    }
+    // from the first row on, code and stdout buffers are paged in by then
+    printf("RSS growth: %ld KiB\n", samples.back().rss_kib - samples.front().rss_kib);
+    if (!json.empty() && writeJson(json, frame_ms, sim_hz, samples) < 0) {
+        return 1;
+    }
+    return 0;
+}
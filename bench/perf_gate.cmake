@@ -0,0 +1,211 @@
+# Runs one benchmark with --json and compares it with a checked-in baseline, see README "Performance gates"
+#   cmake -DBENCH=<exe> -DBENCH_ARGS="<args>" -DRESULT=<json> -DBASELINE=<json> -DBUILD_TYPE=<type> [-DRUNS=<n>] [-DUPDATE=ON]
+#         -P perf_gate.cmake
+# A gate fails when the value is worse than baseline * (1 + tolerance_pct / 100) + slack (baseline * (1 - ...) - slack
+# for higher_is_better). With RUNS > 1 the benchmark runs that often and the median of each metric is compared, so one
+# preempted run does not fail a tail latency gate. UPDATE=ON writes the measured values into the baseline instead,
+# limits are kept.
+cmake_minimum_required(VERSION 3.19) # string(JSON)
+
+# math(EXPR) is integer only, values are compared in millionths
+function(to_micro text out)
+    if(NOT text MATCHES "^(-?)([0-9]+)(\\.([0-9]*))?([eE]([-+]?[0-9]+))?$")
+        message(FATAL_ERROR "Not a number: ${text}")
+    endif()
+    set(sign "${CMAKE_MATCH_1}")
+    set(digits "${CMAKE_MATCH_2}${CMAKE_MATCH_4}")
+    string(LENGTH "${CMAKE_MATCH_4}" frac_len)
+    set(exponent 0)
+    if(NOT "${CMAKE_MATCH_6}" STREQUAL "")
+        set(exponent "${CMAKE_MATCH_6}")
+    endif()
+    math(EXPR shift "${exponent} - ${frac_len} + 6")
+    if(shift GREATER_EQUAL 0)
+        string(REPEAT "0" ${shift} zeros)
+        string(APPEND digits "${zeros}")
+    else()
+        string(LENGTH "${digits}" len)
+        math(EXPR keep "${len} + ${shift}")
+        if(keep LESS_EQUAL 0)
+            set(digits "0")
+        else()
+            string(SUBSTRING "${digits}" 0 ${keep} digits)
+        endif()
+    endif()
+    if(digits MATCHES "^0*([0-9].*)$") # REGEX REPLACE would match ^ again after every replacement
+        set(digits "${CMAKE_MATCH_1}")
+    endif()
+    set(${out} "${sign}${digits}" PARENT_SCOPE)
+endfunction()
+
+# rounded to 3 fraction digits without trailing zeros, keeps the baseline files readable
+function(format_number text out)
+    to_micro("${text}" micro)
+    set(sign "")
+    if(micro LESS 0)
+        set(sign "-")
+        math(EXPR micro "0 - ${micro}")
+    endif()
+    math(EXPR micro "(${micro} + 500) / 1000 * 1000")
+    math(EXPR int_part "${micro} / 1000000")
+    math(EXPR frac "${micro} % 1000000 + 1000000")
+    string(SUBSTRING "${frac}" 1 3 frac)
+    if(frac MATCHES "^([0-9]*[1-9])0*$")
+        set(frac "${CMAKE_MATCH_1}")
+    else()
+        set(frac "")
+    endif()
+    if(frac STREQUAL "")
+        set(${out} "${sign}${int_part}" PARENT_SCOPE)
+    else()
+        set(${out} "${sign}${int_part}.${frac}" PARENT_SCOPE)
+    endif()
+endfunction()
+
+# inverse of to_micro, all six fraction digits
+function(from_micro micro out)
+    set(sign "")
+    if(micro LESS 0)
+        set(sign "-")
+        math(EXPR micro "0 - ${micro}")
+    endif()
+    math(EXPR int_part "${micro} / 1000000")
+    math(EXPR frac "${micro} % 1000000 + 1000000")
+    string(SUBSTRING "${frac}" 1 6 frac)
+    set(${out} "${sign}${int_part}.${frac}" PARENT_SCOPE)
+endfunction()
+
+# optional numeric member of a gate
+function(gate_member json index member default out)
+    string(JSON value ERROR_VARIABLE error GET "${json}" gates ${index} ${member})
+    if(error)
+        set(value "${default}")
+    endif()
+    set(${out} "${value}" PARENT_SCOPE)
+endfunction()
+
+file(READ "${BASELINE}" baseline)
+string(JSON baseline_type GET "${baseline}" build_type)
+if(NOT UPDATE AND NOT baseline_type STREQUAL BUILD_TYPE)
+    # timings of a Debug build say nothing against a Release baseline
+    message("PERF GATE SKIPPED: the baseline is from a '${baseline_type}' build, this is '${BUILD_TYPE}'")
+    return()
+endif()
+
+if(NOT RUNS)
+    set(RUNS 1)
+endif()
+separate_arguments(args UNIX_COMMAND "${BENCH_ARGS}")
+set(results "")
+foreach(run RANGE 1 ${RUNS})
+    execute_process(COMMAND "${BENCH}" ${args} --json "${RESULT}" RESULT_VARIABLE status)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "${BENCH} failed: ${status}")
+    endif()
+    file(READ "${RESULT}" result)
+    list(APPEND results "${result}")
+endforeach()
+
+# median over the runs, in millionths; empty if a run lacks the metric
+function(median_value case_name metric out)
+    set(values "")
+    foreach(result IN LISTS results)
+        set(value "")
+        string(JSON case_count LENGTH "${result}" cases)
+        math(EXPR last_case "${case_count} - 1")
+        foreach(j RANGE ${last_case})
+            string(JSON name GET "${result}" cases ${j} name)
+            if(name STREQUAL case_name)
+                string(JSON value ERROR_VARIABLE error GET "${result}" cases ${j} ${metric})
+            endif()
+        endforeach()
+        if(value STREQUAL "" OR value MATCHES "NOTFOUND")
+            set(${out} "" PARENT_SCOPE)
+            return()
+        endif()
+        to_micro("${value}" value_u)
+        list(APPEND values ${value_u})
+    endforeach()
+    list(SORT values COMPARE NATURAL) # the metrics are not negative
+    list(LENGTH values count)
+    math(EXPR middle "${count} / 2")
+    list(GET values ${middle} median)
+    set(${out} "${median}" PARENT_SCOPE)
+endfunction()
+
+string(JSON gate_count LENGTH "${baseline}" gates)
+math(EXPR last_gate "${gate_count} - 1")
+set(failures 0)
+foreach(i RANGE ${last_gate})
+    string(JSON case_name GET "${baseline}" gates ${i} case)
+    string(JSON metric GET "${baseline}" gates ${i} metric)
+    median_value("${case_name}" "${metric}" value_u)
+    if(value_u STREQUAL "")
+        message("FAIL ${case_name}/${metric}: missing from the benchmark output")
+        math(EXPR failures "${failures} + 1")
+        continue()
+    endif()
+    from_micro(${value_u} value)
+    if(UPDATE)
+        # one gate per line, the limits are kept as they are
+        format_number("${value}" value)
+        gate_member("${baseline}" ${i} tolerance_pct 0 tolerance)
+        gate_member("${baseline}" ${i} slack "" slack)
+        gate_member("${baseline}" ${i} higher_is_better OFF higher)
+        set(gate "    {\"case\": \"${case_name}\", \"metric\": \"${metric}\", \"baseline\": ${value}, \"tolerance_pct\": ${tolerance}")
+        if(NOT slack STREQUAL "")
+            format_number("${slack}" slack)
+            string(APPEND gate ", \"slack\": ${slack}")
+        endif()
+        if(higher)
+            string(APPEND gate ", \"higher_is_better\": true")
+        endif()
+        list(APPEND updated "${gate}}")
+        message("${case_name}/${metric}: ${value}")
+        continue()
+    endif()
+
+    string(JSON base GET "${baseline}" gates ${i} baseline)
+    gate_member("${baseline}" ${i} tolerance_pct 0 tolerance)
+    gate_member("${baseline}" ${i} slack 0 slack)
+    gate_member("${baseline}" ${i} higher_is_better OFF higher)
+    format_number("${value}" value)
+    to_micro("${base}" base_u)
+    to_micro("${slack}" slack_u)
+    if(higher)
+        math(EXPR limit_u "${base_u} * (100 - ${tolerance}) / 100 - ${slack_u}")
+        set(bad OFF)
+        if(value_u LESS limit_u)
+            set(bad ON)
+        endif()
+    else()
+        math(EXPR limit_u "${base_u} * (100 + ${tolerance}) / 100 + ${slack_u}")
+        set(bad OFF)
+        if(value_u GREATER limit_u)
+            set(bad ON)
+        endif()
+    endif()
+    if(limit_u LESS 0)
+        set(limit_u 0) # only printed from here on
+    endif()
+    math(EXPR limit_int "${limit_u} / 1000000")
+    math(EXPR limit_frac "${limit_u} % 1000000 + 1000000")
+    string(SUBSTRING "${limit_frac}" 1 3 limit_frac)
+    format_number("${base}" base) # string(JSON) prints the double it parsed, 724.071 becomes 724.07100000000003
+    set(line "${case_name}/${metric}: ${value}, baseline ${base}, limit ${limit_int}.${limit_frac}")
+    if(bad)
+        message("FAIL ${line}")
+        math(EXPR failures "${failures} + 1")
+    else()
+        message("ok   ${line}")
+    endif()
+endforeach()
+
+if(failures GREATER 0)
+    message(FATAL_ERROR "${failures} performance regression(s) against ${BASELINE}")
+elseif(UPDATE)
+    string(JSON benchmark GET "${baseline}" benchmark)
+    list(JOIN updated ",\n" gates)
+    file(WRITE "${BASELINE}" "{\n  \"benchmark\": \"${benchmark}\",\n  \"build_type\": \"${BUILD_TYPE}\",\n  \"gates\": [\n${gates}\n  ]\n}\n")
+    message("Baseline updated: ${BASELINE}")
+endif()
@@ -0,0 +1,204 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+// Baseline of the DataSender send path: frames through a loopback FrameSink, as fast as possible and paced
+
+#include "data_sender.h"
+#include "frame_sink.h"
+#include "latency_histogram.h"
+#include "tx_timestamps.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static uint64_t threadCpuNs(void) {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+struct CaseResult {
+    std::string name;
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    uint64_t malformed = 0;
+    double packets_per_s = 0.0;
+    double cpu_ns_per_pkt = 0.0; // sender thread only, the sink runs on its own thread
+    double syscalls_per_pkt = 0.0;
+    LatencyHistogram send_ns; // time spent inside sendData()
+};
+
+/* rate_hz == 0: send_queue as fast as possible, otherwise send_latest paced with absolute sleeps */
+static bool runCase(CaseResult& result, TransportBackend backend, int frames, int rate_hz) {
+    FrameSink sink;
+    if (sink.listen("127.0.0.1:0") < 0) {
+        return false;
+    }
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool> stop{false};
+    sink.setFrameCallback([&](uint64_t, const r_remote_data&, uint64_t) { received++; });
+    std::thread receiver([&] {
+        while (!stop) {
+            sink.poll(10);
+        }
+    });
+
+    DataSender sender;
+    sender.setBackend(backend, false);
+    sender.setSendMode(rate_hz > 0 ? send_latest : send_queue, 2);
+    sender.openSocket("127.0.0.1", sink.getPort());
+    while (sender.updateConnection() == conn_connecting) {
+        usleep(100);
+    }
+    bool ok = sender.isConnected();
+    if (ok) {
+        r_remote_data data{};
+        data.header = R_HEADER_VALUE;
+        SenderStats before = sender.getStats();
+        uint64_t wall0 = monotonicNs();
+        uint64_t cpu0 = threadCpuNs();
+        timespec next;
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        for (int i = 0; i < frames; i++) {
+            data.head.center.position.x = static_cast<float>(i);
+            uint64_t t0 = monotonicNs();
+            sender.sendData(data);
+            result.send_ns.record(monotonicNs() - t0);
+            if (rate_hz > 0) {
+                next.tv_nsec += 1000000000L / rate_hz;
+                if (next.tv_nsec >= 1000000000L) {
+                    next.tv_nsec -= 1000000000L;
+                    next.tv_sec++;
+                }
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+            }
+        }
+        uint64_t cpu = threadCpuNs() - cpu0;
+        SenderStats after = sender.getStats();
+        result.sent = after.sent - before.sent;
+        // packets/s counts what the receiver got, including the time to drain the socket
+        while (received < after.sent && monotonicNs() - wall0 < 60000000000ULL) {
+            usleep(50);
+        }
+        double wall = (monotonicNs() - wall0) / 1e9;
+        result.received = received;
+        result.packets_per_s = result.received / wall;
+        result.cpu_ns_per_pkt = static_cast<double>(cpu) / std::max<uint64_t>(result.sent, 1);
+        // getStats() itself issues one SIOCOUTQ ioctl
+        result.syscalls_per_pkt = static_cast<double>(after.syscalls - before.syscalls - 1)
+                                  / std::max<uint64_t>(result.sent, 1);
+    } else {
+        std::cerr << result.name << ": connection failed" << std::endl;
+    }
+    sender.closeSocket();
+    stop = true;
+    receiver.join();
+    sink.poll(0); // see the close, so the client shows up with its final counters
+    for (const auto& client : sink.getClients(true)) {
+        result.malformed += client.malformed;
+    }
+    return ok;
+}
+
+static void printResult(const CaseResult& r) {
+    printf("%-18s %10llu %11.0f %10.0f %10.3f %9.1f %9.1f %9.1f %9.1f %9llu\n", r.name.c_str(),
+           (unsigned long long)r.received, r.packets_per_s, r.cpu_ns_per_pkt, r.syscalls_per_pkt,
+           r.send_ns.getPercentile(50.0) / 1000.0, r.send_ns.getPercentile(99.0) / 1000.0,
+           r.send_ns.getPercentile(99.9) / 1000.0, r.send_ns.getMax() / 1000.0, (unsigned long long)r.malformed);
+}
+
+static int writeJson(const std::string& path, const std::vector<CaseResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return -1;
+    }
+    out << "{\n  \"benchmark\": \"sender\",\n  \"frame_bytes\": " << sizeof(r_remote_data) << ",\n  \"cases\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const CaseResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"sent\": " << r.sent << ", \"received\": " << r.received
+            << ", \"malformed\": " << r.malformed << ", \"packets_per_s\": " << r.packets_per_s
+            << ", \"cpu_ns_per_pkt\": " << r.cpu_ns_per_pkt << ", \"syscalls_per_pkt\": " << r.syscalls_per_pkt
+            << ", \"send_p50_us\": " << r.send_ns.getPercentile(50.0) / 1000.0
+            << ", \"send_p99_us\": " << r.send_ns.getPercentile(99.0) / 1000.0
+            << ", \"send_p999_us\": " << r.send_ns.getPercentile(99.9) / 1000.0
+            << ", \"send_max_us\": " << r.send_ns.getMax() / 1000.0 << "}" << (i + 1 < results.size() ? "," : "")
+            << "\n";
+    }
+    out << "  ]\n}\n";
+    return out ? 0 : -1;
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [-n frames] [-d seconds] [-r rate,rate,...] [-b socket|uring] [--json path]\n", name);
+    printf("  -n  frames of the unpaced case, default 200000\n");
+    printf("  -d  duration of every paced case, default 2 s\n");
+    printf("  -r  paced rates in Hz, default 250,1000,2000\n");
+}
+
+int main(int argc, char** argv) {
+    int frames = 200000;
+    int seconds = 2;
+    std::vector<int> rates = {250, 1000, 2000};
+    TransportBackend backend = backend_socket;
+    std::string json;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (arg == "-d" && i + 1 < argc) {
+            seconds = std::atoi(argv[++i]);
+        } else if (arg == "-r" && i + 1 < argc) {
+            rates.clear();
+            std::istringstream in(argv[++i]);
+            std::string rate;
+            while (std::getline(in, rate, ',')) {
+                rates.push_back(std::atoi(rate.c_str()));
+            }
+        } else if (arg == "-b" && i + 1 < argc) {
+            backend = strcmp(argv[++i], "uring") == 0 ? backend_uring : backend_socket;
+        } else if (arg == "--json" && i + 1 < argc) {
+            json = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<CaseResult> results;
+    printf("Frames of %zu bytes to a loopback FrameSink, %s backend, send = time inside sendData()\n",
+           sizeof(r_remote_data), backend == backend_uring ? "io_uring" : "BSD socket");
+    printf("%-18s %10s %11s %10s %10s %9s %9s %9s %9s %9s\n", "case", "received", "packets/s", "cpu ns/pkt",
+           "sys/pkt", "send p50", "p99 us", "p99.9 us", "max us", "malformed");
+    results.emplace_back();
+    results.back().name = "max-queue";
+    if (runCase(results.back(), backend, frames, 0)) {
+        printResult(results.back());
+    }
+    for (int rate : rates) {
+        if (rate <= 0) {
+            continue;
+        }
+        results.emplace_back();
+        results.back().name = "latest-" + std::to_string(rate) + "hz";
+        if (runCase(results.back(), backend, rate * seconds, rate)) {
+            printResult(results.back());
+        }
+    }
+    if (!json.empty() && writeJson(json, results) < 0) {
+        return 1;
+    }
+    return 0;
+}
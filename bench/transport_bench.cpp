@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+// Same-host comparison of the TCP, Unix socket and shared memory transports: throughput and one-way latency
+
+#include "data_sender.h"
+#include "frame_stamp.h"
+#include "shm_ring.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+static double cpuSeconds(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct Receiver {
+    std::atomic<uint64_t> frames{0};
+    std::atomic<bool> stop{false};
+    FrameStampTracker stamps; // read after the receiver thread joined
+};
+
+static void receiveFrame(Receiver* rx, const r_remote_data& frame) {
+    rx->stamps.add(frame, realtimeNs());
+    rx->frames++;
+}
+
+/* Blocking reads like monado-service does, frames are reassembled from the byte stream */
+static void streamReceiver(int listen_fd, Receiver* rx) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+        return;
+    }
+    r_remote_data frame;
+    size_t off = 0;
+    ssize_t n;
+    while ((n = recv(fd, reinterpret_cast<char*>(&frame) + off, sizeof(frame) - off, 0)) > 0) {
+        off += n;
+        if (off == sizeof(frame)) {
+            receiveFrame(rx, frame);
+            off = 0;
+        }
+    }
+    close(fd);
+}
+
+/* The ring has no wakeup, the receiver polls it */
+static void shmReceiver(ShmRing* ring, Receiver* rx) {
+    r_remote_data frame;
+    while (!rx->stop) {
+        if (ring->pop(frame)) {
+            receiveFrame(rx, frame);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+static int listenTcp(std::string& address) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0; // any free port, do not collide with a running monado-service
+    socklen_t len = sizeof(addr);
+    if (fd < 0 || bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 1) < 0
+        || getsockname(fd, (sockaddr*)&addr, &len) < 0) {
+        perror("tcp listen");
+        return -1;
+    }
+    address = "127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+    return fd;
+}
+
+static int listenUnix(std::string& address, const std::string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());
+    if (fd < 0 || bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 1) < 0) {
+        perror("unix listen");
+        return -1;
+    }
+    address = "unix:" + path;
+    return fd;
+}
+
+/* rate_hz == 0 sends in send_queue mode as fast as possible, otherwise paced send_latest frames */
+static void runCase(TransportKind kind, int frames, int rate_hz) {
+    Receiver rx;
+    std::string address;
+    std::string unix_path = "/tmp/mndset-bench-" + std::to_string(getpid()) + ".sock";
+    std::string shm_name = "/mndset-bench-" + std::to_string(getpid());
+    int listen_fd = -1;
+    ShmRing ring;
+    std::thread receiver;
+    if (kind == transport_shm) {
+        if (ring.create(shm_name, 256) < 0) {
+            return;
+        }
+        address = "shm:" + shm_name;
+        receiver = std::thread(shmReceiver, &ring, &rx);
+    } else {
+        listen_fd = kind == transport_tcp ? listenTcp(address) : listenUnix(address, unix_path);
+        if (listen_fd < 0) {
+            return;
+        }
+        receiver = std::thread(streamReceiver, listen_fd, &rx);
+    }
+
+    DataSender sender;
+    sender.setSendMode(rate_hz > 0 ? send_latest : send_queue, 2);
+    sender.setFrameStamps(rate_hz > 0);
+    sender.openSocket(address);
+    while (sender.updateConnection() == conn_connecting) {
+        usleep(100);
+    }
+    if (sender.isConnected()) {
+        r_remote_data data{};
+        data.header = R_HEADER_VALUE;
+        SenderStats before = sender.getStats();
+        double wall0 = cpuSeconds(CLOCK_MONOTONIC);
+        double thread0 = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+        timespec next;
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        for (int i = 0; i < frames; i++) {
+            data.head.center.position.x = static_cast<float>(i);
+            sender.sendData(data);
+            if (rate_hz > 0) {
+                next.tv_nsec += 1000000000L / rate_hz;
+                if (next.tv_nsec >= 1000000000L) {
+                    next.tv_nsec -= 1000000000L;
+                    next.tv_sec++;
+                }
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+            }
+        }
+        SenderStats after = sender.getStats();
+        double thread_cpu = cpuSeconds(CLOCK_THREAD_CPUTIME_ID) - thread0;
+        // wait until the receiver has everything the sender handed over
+        while (rx.frames < after.sent && cpuSeconds(CLOCK_MONOTONIC) - wall0 < 60.0) {
+            usleep(50);
+        }
+        double wall = cpuSeconds(CLOCK_MONOTONIC) - wall0;
+        uint64_t sent = after.sent - before.sent;
+        // getStats() itself issues one SIOCOUTQ ioctl on the socket transports
+        double syscalls = static_cast<double>(after.syscalls - before.syscalls) - (kind == transport_shm ? 0 : 1);
+        if (rate_hz > 0) {
+            LatencySummary l = rx.stamps.getLatency().getSummary();
+            printf("%-14s %10llu %6llu %12.3f %14.0f %10.1f %10.1f %10.1f\n", transportName(kind),
+                   (unsigned long long)rx.frames.load(), (unsigned long long)rx.stamps.getLost(),
+                   syscalls / sent, thread_cpu * 1e9 / sent, l.p50_us, l.p99_us, l.max_us);
+        } else {
+            printf("%-14s %10.0f %12.3f %14.0f\n", transportName(kind), rx.frames / wall,
+                   syscalls / sent, thread_cpu * 1e9 / sent);
+        }
+    } else {
+        std::cerr << transportName(kind) << ": connection failed" << std::endl;
+    }
+
+    sender.closeSocket();
+    rx.stop = true;
+    if (listen_fd >= 0) {
+        shutdown(listen_fd, SHUT_RDWR); // wakes up accept() if the sender never connected
+    }
+    receiver.join();
+    if (listen_fd >= 0) {
+        close(listen_fd);
+    }
+    if (kind == transport_unix) {
+        unlink(unix_path.c_str());
+    }
+    ring.close();
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int rate_hz = argc > 2 ? std::atoi(argv[2]) : 1000;
+    int paced_frames = rate_hz * 2;
+    const TransportKind kinds[] = {transport_tcp, transport_unix, transport_shm};
+    printf("Socket receivers block in recv(), the shared memory receiver polls the ring\n");
+    printf("-- send_queue, %d frames of %zu bytes, as fast as possible\n", frames, sizeof(r_remote_data));
+    printf("%-14s %10s %12s %14s\n", "transport", "frames/s", "syscalls/pkt", "sender ns/pkt");
+    for (TransportKind kind : kinds) {
+        runCase(kind, frames, 0);
+    }
+    printf("-- send_latest, %d frames at %d Hz, one-way latency from the frame stamp to the receiver\n",
+           paced_frames, rate_hz);
+    printf("%-14s %10s %6s %12s %14s %10s %10s %10s\n", "transport", "received", "lost", "syscalls/pkt",
+           "sender ns/pkt", "p50 us", "p99 us", "max us");
+    for (TransportKind kind : kinds) {
+        runCase(kind, paced_frames, rate_hz);
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+// Loopback comparison of the DataSender backends: syscalls and CPU time per packet
+
+#include "data_sender.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+static double cpuSeconds(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Accepts one client and discards everything it sends */
+static void drainReceiver(int listen_fd, std::atomic<uint64_t>* received) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+        return;
+    }
+    static char buf[1 << 16];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        *received += n;
+    }
+    close(fd);
+}
+
+static int listenLoopback(int& port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0; // any free port, do not collide with a running monado-service
+    socklen_t len = sizeof(addr);
+    if (fd < 0 || bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 1) < 0
+        || getsockname(fd, (sockaddr*)&addr, &len) < 0) {
+        perror("listen");
+        return -1;
+    }
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+/* rate_hz == 0 sends in send_queue mode as fast as possible, otherwise paced send_latest frames */
+static void runCase(const char* name, TransportBackend backend, bool sqpoll, int frames, int rate_hz) {
+    int port = 0;
+    int listen_fd = listenLoopback(port);
+    if (listen_fd < 0) {
+        return;
+    }
+    std::atomic<uint64_t> received{0};
+    std::thread receiver(drainReceiver, listen_fd, &received);
+
+    DataSender sender;
+    sender.setBackend(backend, sqpoll);
+    sender.setSendMode(rate_hz > 0 ? send_latest : send_queue, 2);
+    sender.openSocket("127.0.0.1", port);
+    while (sender.updateConnection() == conn_connecting) {
+        usleep(100);
+    }
+    if (!sender.isConnected()) {
+        std::cerr << name << ": connection failed" << std::endl;
+        shutdown(listen_fd, SHUT_RDWR);
+        receiver.join();
+        close(listen_fd);
+        return;
+    }
+
+    r_remote_data data{};
+    data.header = R_HEADER_VALUE;
+    SenderStats before = sender.getStats();
+    double wall0 = cpuSeconds(CLOCK_MONOTONIC);
+    double thread0 = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+    double proc0 = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (int i = 0; i < frames; i++) {
+        data.head.center.position.x = static_cast<float>(i);
+        sender.sendData(data);
+        if (rate_hz > 0) {
+            next.tv_nsec += 1000000000L / rate_hz;
+            if (next.tv_nsec >= 1000000000L) {
+                next.tv_nsec -= 1000000000L;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+        }
+    }
+    double wall = cpuSeconds(CLOCK_MONOTONIC) - wall0;
+    double thread_cpu = cpuSeconds(CLOCK_THREAD_CPUTIME_ID) - thread0;
+    double proc_cpu = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - proc0;
+    SenderStats after = sender.getStats();
+
+    uint64_t sent = after.sent - before.sent;
+    // getStats() itself issues one SIOCOUTQ ioctl
+    double syscalls = static_cast<double>(after.syscalls - before.syscalls - 1);
+    printf("%-16s %-8s %10.0f %12.3f %14.0f %14.0f\n", name,
+           after.backend == backend_uring ? "uring" : "socket",
+           sent / wall, syscalls / sent, thread_cpu * 1e9 / sent, proc_cpu * 1e9 / sent);
+
+    sender.closeSocket();
+    receiver.join();
+    close(listen_fd);
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int rate_hz = argc > 2 ? std::atoi(argv[2]) : 1000;
+    int paced_frames = rate_hz * 2;
+    printf("Receiver runs in the same process, process CPU includes it and the SQPOLL kernel thread\n");
+    printf("%-16s %-8s %10s %12s %14s %14s\n", "case", "active", "packets/s", "syscalls/pkt",
+           "thread ns/pkt", "process ns/pkt");
+    printf("-- send_queue, %d frames of %zu bytes, as fast as possible\n", frames, sizeof(r_remote_data));
+    runCase("bsd-socket", backend_socket, false, frames, 0);
+    runCase("io_uring", backend_uring, false, frames, 0);
+    runCase("io_uring-sqpoll", backend_uring, true, frames, 0);
+    printf("-- send_latest, %d frames at %d Hz\n", paced_frames, rate_hz);
+    runCase("bsd-socket", backend_socket, false, paced_frames, rate_hz);
+    runCase("io_uring", backend_uring, false, paced_frames, rate_hz);
+    runCase("io_uring-sqpoll", backend_uring, true, paced_frames, rate_hz);
+    return 0;
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "change_filter.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+DeadBand deadBandFromConfig(const Config& config) {
+    DeadBand band;
+    band.position = config.dead_band_pos_mm / 1000.0f;
+    band.angle = config.dead_band_angle_deg * static_cast<float>(M_PI) / 180.0f;
+    band.velocity = config.dead_band_vel;
+    band.keepalive_ms = config.keepalive_ms;
+    return band;
+}
+
+ChangeFilter::ChangeFilter() {
+    has_sent = false;
+    suppressed = 0;
+    keepalives = 0;
+    setDeadBand(DeadBand{});
+}
+
+void ChangeFilter::setDeadBand(const DeadBand& dead_band) {
+    band = dead_band;
+    min_quat_dot = std::cos(band.angle / 2.0f);
+}
+
+bool ChangeFilter::vecChanged(const xrt_vec3& a, const xrt_vec3& b, float threshold) const {
+    float dx = a.x - b.x;
+    float dy = a.y - b.y;
+    float dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz > threshold * threshold;
+}
+
+bool ChangeFilter::poseChanged(const xrt_pose& a, const xrt_pose& b) const {
+    if (vecChanged(a.position, b.position, band.position)) {
+        return true;
+    }
+    const xrt_quat& p = a.orientation;
+    const xrt_quat& q = b.orientation;
+    float dot = std::fabs(p.x * q.x + p.y * q.y + p.z * q.z + p.w * q.w); // q and -q are the same rotation
+    return dot < min_quat_dot;
+}
+
+bool ChangeFilter::controllerChanged(const r_remote_controller_data& a, const r_remote_controller_data& b) const {
+    if (poseChanged(a.pose, b.pose) || vecChanged(a.linear_velocity, b.linear_velocity, band.velocity)
+        || vecChanged(a.angular_velocity, b.angular_velocity, band.velocity)) {
+        return true;
+    }
+    // analog inputs and buttons are compared exactly, a click must never be swallowed
+    const size_t analog_begin = offsetof(r_remote_controller_data, hand_curl);
+    const size_t buttons_end = offsetof(r_remote_controller_data, _pad0);
+    return memcmp(reinterpret_cast<const char*>(&a) + analog_begin,
+                  reinterpret_cast<const char*>(&b) + analog_begin, buttons_end - analog_begin) != 0;
+}
+
+bool ChangeFilter::shouldSend(const r_remote_data& data, std::chrono::steady_clock::time_point now) {
+    bool send = !has_sent
+                || now - last_send_time >= std::chrono::milliseconds(band.keepalive_ms)
+                || poseChanged(data.head.center, last_sent.head.center)
+                || data.head.per_view_data_valid != last_sent.head.per_view_data_valid
+                || controllerChanged(data.left, last_sent.left)
+                || controllerChanged(data.right, last_sent.right);
+    if (!send) {
+        suppressed++;
+        return false;
+    }
+    if (has_sent && memcmp(&data, &last_sent, sizeof(data)) == 0) {
+        keepalives++; // nothing changed, sent only to keep the device alive in Monado
+    }
+    last_sent = data;
+    has_sent = true;
+    last_send_time = now;
+    return true;
+}
+
+void ChangeFilter::reset(void) {
+    has_sent = false;
+}
+
+uint64_t ChangeFilter::getSuppressed(void) {
+    return suppressed;
+}
+
+uint64_t ChangeFilter::getKeepalives(void) {
+    return keepalives;
+}
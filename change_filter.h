@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef CHANGE_FILTER_H
+#define CHANGE_FILTER_H
+
+#include "structs.h"
+
+#include <chrono>
+
+// Dead-band for send-on-change mode, a frame is sent if it differs enough from the last sent one
+struct DeadBand {
+    float position = 0.0005f; // m
+    float angle = 0.001f; // rad
+    float velocity = 0.01f; // m/s and rad/s
+    int keepalive_ms = 100; // resend the newest frame at least this often
+};
+
+// converts the user facing units (mm, degrees) from Config
+DeadBand deadBandFromConfig(const Config& config);
+
+class ChangeFilter {
+    DeadBand band;
+    float min_quat_dot; // cos(angle / 2), compared instead of computing the angle
+    r_remote_data last_sent{};
+    bool has_sent;
+    std::chrono::steady_clock::time_point last_send_time;
+    uint64_t suppressed;
+    uint64_t keepalives;
+
+    bool poseChanged(const xrt_pose& a, const xrt_pose& b) const;
+    bool vecChanged(const xrt_vec3& a, const xrt_vec3& b, float threshold) const;
+    bool controllerChanged(const r_remote_controller_data& a, const r_remote_controller_data& b) const;
+public:
+    ChangeFilter();
+    void setDeadBand(const DeadBand& dead_band);
+    bool shouldSend(const r_remote_data& data, std::chrono::steady_clock::time_point now);
+    void reset(void); // next frame is always sent, e.g. after reconnecting
+    uint64_t getSuppressed(void);
+    uint64_t getKeepalives(void);
+};
+
+#endif // CHANGE_FILTER_H
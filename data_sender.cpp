@@ -5,71 +5,416 @@
 
 
 #include "data_sender.h"
+#include "socket_transport.h"
+#include "uring_transport.h"
+#include "shm_transport.h"
+#include "tcp_info.h"
 
+#include <algorithm>
 #include <iostream>
 #include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <unistd.h> // for close socket
 
 DataSender::DataSender() {
-    sockfd = -1;
+    state = conn_disconnected;
+    transport_backend = backend_socket;
+    transport_is_shm = false;
+    connect_timeout_ms = 2000;
+    auto_reconnect = true;
+    backoff_ms = min_backoff_ms;
+    protocol = defaultWireProtocol();
+    frame_stamps = false;
+    tx_seq = 0;
+    send_mode = send_queue; // the delivery of the original blocking sender
+    max_backlog_frames = 2;
+    tx_len = 0;
+    tx_off = 0;
+    tx_busy = false;
+    has_pending = false;
+    frames_skipped = false;
+    backlog_bound = 0;
+    socket_full = false;
+    backend = backend_socket;
+    uring_sqpoll = false;
+    uring_unavailable = false;
+    retired_syscalls = 0;
+    tx_timestamps = false;
+    pending_submit_ns = 0;
+    pending_origin_ns = 0;
+    tx_submit_ns = 0;
+    tx_write_ns = 0;
 }
 
-int DataSender::openSocket(std::string server_ip) {
-    if (isSocketOpened()){
-        closeSocket();
+/* Starts a non-blocking connection, progress is checked in updateConnection() */
+int DataSender::openSocket(std::string server_ip, int port) {
+    closeSocket();
+    this->server_ip = server_ip;
+    backoff_ms = min_backoff_ms;
+    if (parseTransportAddress(server_ip, port, address) < 0 || (address.kind == transport_tcp && address.port == 0)) {
+        std::cerr << "Adress conversion error!" << std::endl;
+        state = conn_disconnected; // retrying will not fix a malformed address
+        return -1;
     }
+    return startConnect();
+}
 
-    sockfd = socket(AF_INET, SOCK_STREAM, 0);
-    if (sockfd < 0) {
-        std::cerr << "Socked creation failed!" << std::endl;
-        return -1;
+/* Keeps the transport while it still fits the address and backend, so the io_uring ring is reused */
+void DataSender::prepareTransport(void) {
+    bool shm = address.kind == transport_shm;
+    bool use_uring = !shm && backend == backend_uring && !uring_unavailable;
+    if (transport && transport_is_shm == shm && (transport_backend == backend_uring) == use_uring
+        && (!use_uring || static_cast<UringTransport*>(transport.get())->usesSqpoll() == uring_sqpoll)) {
+        return;
+    }
+    if (transport) {
+        retired_syscalls += transport->getSyscalls();
     }
+    transport_is_shm = shm;
+    transport_backend = backend_socket;
+    if (shm) {
+        transport = std::make_unique<ShmTransport>();
+        return;
+    }
+    if (use_uring) {
+        auto uring_transport = std::make_unique<UringTransport>();
+        if (uring_transport->setup(uring_sqpoll, max_wire_frame_size) == 0) {
+            uring_transport->setResolver(resolver);
+            transport = std::move(uring_transport);
+            transport_backend = backend_uring;
+            return;
+        }
+        std::cerr << "io_uring is not available, falling back to BSD sockets" << std::endl;
+        retired_syscalls += uring_transport->getSyscalls();
+        uring_unavailable = true;
+    }
+    auto socket_transport = std::make_unique<SocketTransport>();
+    socket_transport->setResolver(resolver);
+    transport = std::move(socket_transport);
+}
 
-    sockaddr_in server_addr{};
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(MONADO_PORT);
-    if (inet_pton(AF_INET, server_ip.c_str(), &server_addr.sin_addr) <= 0) {
-        std::cerr << "Adress conversion error!" << std::endl;
-        closeSocket();
+int DataSender::startConnect(void) {
+    prepareTransport();
+    state = conn_connecting;
+    if (transport->open(address, connect_timeout_ms) < 0) {
+        state = conn_disconnected;
         return -1;
     }
+    checkTransport();
+    return 0;
+}
+
+/* Follows the transport through connecting and notices when it gives up the connection */
+void DataSender::checkTransport(void) {
+    ConnectionState transport_state = transport->update();
+    if (transport_state == conn_connected && state == conn_connecting) {
+        connectDone();
+    } else if (transport_state == conn_disconnected) {
+        connectFailed(transport->getError().c_str());
+    }
+}
+
+/* Drops the connection and, if enabled, schedules the next attempt with exponential backoff */
+void DataSender::connectFailed(const char* reason) {
+    timestamper.disable();
+    transport->close();
+    resetTx();
+    if (!auto_reconnect) {
+        std::cerr << "Server connection error: " << reason << std::endl;
+        state = conn_disconnected;
+        return;
+    }
+    std::cerr << "Server connection error: " << reason << ", retrying in " << backoff_ms << " ms" << std::endl;
+    state = conn_reconnect_wait;
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(backoff_ms);
+    backoff_ms = std::min(backoff_ms * 2, max_backoff_ms);
+}
+
+void DataSender::connectDone(void) {
+    if (tx_timestamps && address.kind == transport_tcp) {
+        timestamper.enable(transport->getFd()); // nothing is sent yet, so OPT_ID counts from our first byte
+    }
+    state = conn_connected;
+    backoff_ms = min_backoff_ms;
+    std::cout << "Connected to " << server_ip << " (" << transport->describe() << ")" << std::endl;
+}
+
+ConnectionState DataSender::updateConnection(void) {
+    if (state == conn_connecting || state == conn_connected) {
+        checkTransport();
+    } else if (state == conn_reconnect_wait && std::chrono::steady_clock::now() >= deadline) {
+        startConnect();
+    }
+    return state;
+}
+
+ConnectionState DataSender::getState(void) {
+    return state;
+}
+
+int DataSender::getRetryDelay(void) {
+    if (state != conn_reconnect_wait) {
+        return 0;
+    }
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return std::max(0, static_cast<int>(left.count()));
+}
+
+void DataSender::setConnectTimeout(int timeout_ms) {
+    connect_timeout_ms = std::max(timeout_ms, 1);
+}
+
+void DataSender::setAutoReconnect(bool reconnect) {
+    auto_reconnect = reconnect;
+}
 
-    if (connect(sockfd, (sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        std::cerr << "Server connection error!" << std::endl;
-        closeSocket();
+void DataSender::setSendMode(SendMode mode, int max_backlog) {
+    send_mode = mode;
+    max_backlog_frames = std::max(max_backlog, 1);
+}
+
+int DataSender::setProtocol(int version) {
+    const WireProtocol* p = findWireProtocol(version);
+    if (!p) {
         return -1;
     }
+    protocol = p;
     return 0;
 }
 
+void DataSender::setBackend(TransportBackend backend, bool sqpoll) {
+    if (backend != this->backend || sqpoll != uring_sqpoll) {
+        uring_unavailable = false; // worth another try with the new settings
+    }
+    this->backend = backend;
+    uring_sqpoll = sqpoll;
+}
+
+int DataSender::getBacklog(void) {
+    return transport ? transport->getBacklog() : 0;
+}
+
+void DataSender::setTxTimestamps(bool enable) {
+    tx_timestamps = enable;
+}
+
+void DataSender::setFrameStamps(bool enable) {
+    frame_stamps = enable;
+}
+
+void DataSender::setResolver(std::shared_ptr<Resolver> resolver) {
+    this->resolver = resolver;
+}
+
+/* Applies setTxTimestamps() and drains the error queue, call it regularly while connected */
+int DataSender::collectTimestamps(void) {
+    if (!isConnected()) {
+        return 0;
+    }
+    if (!tx_timestamps && timestamper.isEnabled()) {
+        unsigned flags = 0;
+        setsockopt(transport->getFd(), SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+        timestamper.disable();
+    }
+    if (tx_timestamps && !timestamper.isEnabled() && address.kind == transport_tcp && !tx_busy && getBacklog() == 0) {
+        // OPT_ID counts from the first unacknowledged byte, so enable only on an idle socket
+        timestamper.enable(transport->getFd());
+    }
+    return timestamper.collect();
+}
+
+int DataSender::sampleTcpInfo(TcpInfoSample& sample) {
+    if (!isConnected() || address.kind != transport_tcp) {
+        sample = TcpInfoSample{};
+        return -1;
+    }
+    return readTcpInfo(transport->getFd(), sample);
+}
+
+TxLatencyStats DataSender::getTxLatency(void) {
+    return timestamper.getStats();
+}
+
+SenderStats DataSender::getStats(void) {
+    stats.backlog_bytes = getBacklog();
+    stats.syscalls = retired_syscalls + timestamper.getSyscalls() + (transport ? transport->getSyscalls() : 0);
+    stats.backend = transport_backend;
+    return stats;
+}
+
 bool DataSender::isSocketOpened(void){
-    if (sockfd >= 0)
-        return true;
-    else
-        return false;
+    return state == conn_connecting || state == conn_connected;
+}
+
+bool DataSender::isConnected(void){
+    return state == conn_connected;
+}
+
+TransportKind DataSender::getTransport(void) {
+    return address.kind;
 }
 
 void DataSender::closeSocket(void){
-    if (isSocketOpened()) {
-        close(sockfd);
-        sockfd = -1;
+    timestamper.disable();
+    if (transport) {
+        transport->close();
     }
+    state = conn_disconnected;
+    resetTx();
 }
 
-int DataSender::sendData(const r_remote_data& data){
-    if (!isSocketOpened()){
-        return -1;
+void DataSender::resetTx(void) {
+    tx_off = 0;
+    tx_busy = false;
+    has_pending = false;
+    frames_skipped = false;
+    backlog_bound = 0;
+    socket_full = false;
+}
+
+/* Serializes data into tx_buf for its first write, a stamp goes into a copy of it */
+void DataSender::commitTx(const r_remote_data& data, uint64_t origin_ns) {
+    if (frame_stamps) {
+        r_remote_data frame = data;
+        writeFrameStamp(frame, tx_seq++, origin_ns ? origin_ns : realtimeNs());
+        tx_len = protocol->serialize(frame, tx_buf);
+    } else {
+        tx_len = protocol->serialize(data, tx_buf);
     }
-    // ssize_t send(int socket, const void *buffer, size_t length, int flags);
-    if (send(sockfd, &data, sizeof(data), 0) < 0) {
-        std::cerr << "Data sending error!" << std::endl;
+    tx_off = 0;
+}
+
+void DataSender::frameDone(void) {
+    tx_off = 0;
+    tx_busy = false;
+    stats.sent++;
+    timestamper.frameWritten(tx_submit_ns, tx_write_ns);
+}
+
+/* Writes the rest of tx_buf, returns 1 when complete, 0 if the transport is full, -1 on error */
+int DataSender::writeFrame(void) {
+    if (tx_off == 0 && !tx_busy && timestamper.isEnabled()) {
+        tx_write_ns = realtimeNs();
+    }
+    int n = transport->write(tx_buf + tx_off, tx_len - tx_off);
+    if (n < 0) {
+        connectFailed(transport->getError().c_str());
         return -1;
     }
+    if (n > 0) {
+        tx_off += n;
+        timestamper.addBytes(n);
+        if (tx_off < tx_len) {
+            stats.partial_writes++;
+        }
+    }
+    socket_full = tx_off < tx_len;
+    if (!socket_full) {
+        frameDone();
+        return 1;
+    }
+    tx_busy = tx_off > 0 || transport->isWriting();
     return 0;
 }
 
+/* Every frame goes out in order, waits for the socket like the old blocking send did */
+int DataSender::sendQueued(const r_remote_data& data, uint64_t origin_ns) {
+    has_pending = false;
+    bool have_new = false;
+    while (true) {
+        if (!tx_busy && !have_new) {
+            commitTx(data, origin_ns); // a half written frame is completed first
+            tx_submit_ns = origin_ns ? origin_ns : (timestamper.isEnabled() ? realtimeNs() : 0);
+            have_new = true;
+        }
+        int res = writeFrame();
+        if (res < 0) {
+            return -1;
+        }
+        if (res > 0) {
+            if (have_new) {
+                return 0;
+            }
+            continue;
+        }
+        if (transport->flush(connect_timeout_ms) == 0) {
+            connectFailed("send timeout");
+            return -1;
+        }
+    }
+}
+
+int DataSender::sendData(const r_remote_data& data, uint64_t origin_ns){
+    if (!isConnected()){
+        return -1;
+    }
+    if (send_mode == send_queue) {
+        return sendQueued(data, origin_ns);
+    }
+    // latest wins: the newest frame replaces one still waiting for the backlog to drain
+    if (has_pending) {
+        stats.dropped++;
+        frames_skipped = true;
+    }
+    pending = data;
+    pending_submit_ns = origin_ns ? origin_ns : (timestamper.isEnabled() ? realtimeNs() : 0);
+    pending_origin_ns = origin_ns;
+    has_pending = true;
+    return flushPending();
+}
+
+/* Used by MultiSender to wait for many connections with one epoll_wait */
+int DataSender::getPollFd(uint32_t& events) {
+    if (!isConnected() || !socket_full || (!tx_busy && !has_pending)) {
+        return -1; // a frame held back by max_backlog_frames is retried on the next tick
+    }
+    return transport->getPollFd(events);
+}
+
+bool DataSender::hasPending(void) {
+    return has_pending;
+}
+
+/* Sends the waiting frame if the kernel backlog is below max_backlog_frames */
+int DataSender::flushPending(void) {
+    if (!isConnected()) {
+        return -1;
+    }
+    if (tx_busy) {
+        // a partly written frame has to be completed, otherwise the stream framing breaks
+        int res = writeFrame();
+        if (res <= 0) {
+            return res;
+        }
+    }
+    if (!has_pending) {
+        return 0;
+    }
+    const int max_backlog = max_backlog_frames * static_cast<int>(protocol->frame_size);
+    if (backlog_bound >= max_backlog) {
+        // only ask the kernel when our own writes could have filled the backlog
+        backlog_bound = getBacklog();
+        if (backlog_bound >= max_backlog) {
+            return 0;
+        }
+    }
+    backlog_bound += protocol->frame_size;
+    commitTx(pending, pending_origin_ns);
+    tx_submit_ns = pending_submit_ns;
+    has_pending = false;
+    int res = writeFrame();
+    if (res == 0 && !tx_busy) {
+        has_pending = true; // kernel took nothing, keep it as the newest waiting frame
+        if (frame_stamps) {
+            tx_seq--; // it gets the same number again when it is really sent
+        }
+        return 0;
+    }
+    if (res >= 0 && frames_skipped) {
+        stats.coalesced++;
+        frames_skipped = false;
+    }
+    return res < 0 ? -1 : 0;
+}
+
 DataSender::~DataSender(){
     closeSocket();
     std::cout << "Connection closed" << std::endl;
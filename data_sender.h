@@ -7,17 +7,98 @@
 #define DATA_SENDER_H
 
 #include "structs.h"
+#include "tx_timestamps.h"
+#include "transport.h"
+#include "wire_protocol.h"
+#include "frame_stamp.h"
+#include "resolver.h"
+
+#include <chrono>
+#include <memory>
 
 class DataSender {
-    int sockfd;
+    ConnectionState state;
+    std::string server_ip;
+    TransportAddress address;
+    std::unique_ptr<Transport> transport; // created by startConnect() for the address kind and backend
+    TransportBackend transport_backend; // what transport actually is
+    bool transport_is_shm;
+    std::shared_ptr<Resolver> resolver; // shared by setResolver(), otherwise each transport creates its own
+    int connect_timeout_ms;
+    bool auto_reconnect;
+    int backoff_ms; // delay before the next reconnection attempt
+    std::chrono::steady_clock::time_point deadline; // time of the next attempt
+
+    const WireProtocol* protocol; // serializes every frame, a switch applies from the next frame on
+    bool frame_stamps; // sequence number and send time in the padding bytes
+    uint32_t tx_seq; // keeps counting across reconnects, so the receiver never sees it go back
+    SendMode send_mode;
+    int max_backlog_frames;
+    uint8_t tx_buf[max_wire_frame_size]; // serialized frame being written, possibly only partly accepted by the kernel
+    size_t tx_len; // bytes in tx_buf
+    size_t tx_off; // bytes of tx_buf already written
+    bool tx_busy; // tx_buf is committed to the transport and must be completed before the next one
+    r_remote_data pending{}; // newest frame waiting for the backlog to drain (send_latest)
+    bool has_pending;
+    bool frames_skipped; // pending replaced an older frame since the last send
+    int backlog_bound; // upper bound of the transport backlog, it can only grow by what we write
+    bool socket_full; // last write took nothing, waiting for the poll fd makes sense
+    SenderStats stats;
+
+    TransportBackend backend; // requested, io_uring falls back to the socket transport
+    bool uring_sqpoll;
+    bool uring_unavailable; // setup failed, do not retry until the settings change
+    uint64_t retired_syscalls; // from transports that were replaced
+
+    // SO_TIMESTAMPING, times are CLOCK_REALTIME ns like the kernel timestamps
+    bool tx_timestamps;
+    TxTimestamper timestamper;
+    uint64_t pending_submit_ns;
+    uint64_t pending_origin_ns; // given by the caller, 0 means now
+    uint64_t tx_submit_ns;
+    uint64_t tx_write_ns;
+
+    void prepareTransport(void);
+    int startConnect(void);
+    void checkTransport(void);
+    void connectFailed(const char* reason);
+    void connectDone(void);
+    int writeFrame(void);
+    int sendQueued(const r_remote_data& data, uint64_t origin_ns);
+    void resetTx(void);
+    void commitTx(const r_remote_data& data, uint64_t origin_ns);
+    void frameDone(void);
 public:
     DataSender();
     ~DataSender();
-    int openSocket(std::string server_ip);
+    int openSocket(std::string server_ip, int port = MONADO_PORT); // also unix:/path and shm:/name
+    ConnectionState updateConnection(void);
+    ConnectionState getState(void);
+    int getRetryDelay(void); // ms until the next reconnection attempt
+    void setConnectTimeout(int timeout_ms);
+    void setAutoReconnect(bool reconnect);
+    void setSendMode(SendMode mode, int max_backlog);
+    int setProtocol(int version); // -1 if not supported, the previous version stays
+    void setBackend(TransportBackend backend, bool sqpoll); // applied on the next connection
+    void setTxTimestamps(bool enable);
+    void setFrameStamps(bool enable);
+    void setResolver(std::shared_ptr<Resolver> resolver); // lets endpoints share one lookup cache
+    int collectTimestamps(void);
+    TxLatencyStats getTxLatency(void);
+    int sampleTcpInfo(TcpInfoSample& sample);
+    int getBacklog(void); // bytes not yet acknowledged by the receiver, SIOCOUTQ counts unsent and in flight data
+    SenderStats getStats(void);
     bool isSocketOpened(void);
-    int sendData(const r_remote_data &data);
+    bool isConnected(void);
+    TransportKind getTransport(void);
+    int getPollFd(uint32_t& events); // fd to wait on for a stalled write, -1 if none
+    int sendData(const r_remote_data &data, uint64_t origin_ns = 0); // origin_ns: CLOCK_REALTIME the pose was produced, if earlier than now
+    int flushPending(void);
+    bool hasPending(void); // the last frame given to sendData() is still waiting for the transport
     void closeSocket(void);
 };
 
+static const int min_backoff_ms = 250;
+static const int max_backoff_ms = 8000;
 
 #endif // DATA_SENDER_H
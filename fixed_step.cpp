@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "fixed_step.h"
+
+#include <algorithm>
+
+FixedStep::FixedStep() {
+    step_ns = 1000000; // 1 kHz
+    accumulator_ns = 0;
+    old_ticks_ns = 0;
+    max_frame_ns = 250000000;
+}
+
+/* The accumulated remainder is kept, a rate change does not jump the state */
+void FixedStep::setRate(int rate_hz) {
+    step_ns = 1000000000ULL / std::clamp(rate_hz, min_sim_rate, max_sim_rate);
+}
+
+uint64_t FixedStep::getStepNs(void) const {
+    return step_ns;
+}
+
+int FixedStep::advance(uint64_t ticks_ns) {
+    if (old_ticks_ns == 0 || ticks_ns < old_ticks_ns) {
+        old_ticks_ns = ticks_ns; // first call only starts the clock
+        return 0;
+    }
+    uint64_t frame_ns = ticks_ns - old_ticks_ns;
+    old_ticks_ns = ticks_ns;
+    if (frame_ns > max_frame_ns) {
+        frame_ns = max_frame_ns;
+    }
+    accumulator_ns += frame_ns;
+    int steps = static_cast<int>(accumulator_ns / step_ns);
+    accumulator_ns -= steps * step_ns;
+    return steps;
+}
+
+float FixedStep::getAlpha(void) const {
+    // the remainder can exceed a step for one frame after setRate() shortened it
+    return static_cast<float>(std::min(static_cast<double>(accumulator_ns) / step_ns, 1.0));
+}
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef FIXED_STEP_H
+#define FIXED_STEP_H
+
+#include <cstdint>
+
+static const int min_sim_rate = 60;
+static const int max_sim_rate = 4000;
+
+/* Accumulator for a fixed simulation step: the frame time is cut into whole steps,
+   the remainder carries over to the next frame and gives the interpolation factor */
+class FixedStep {
+    uint64_t step_ns;
+    uint64_t accumulator_ns;
+    uint64_t old_ticks_ns;
+    uint64_t max_frame_ns; // longer frames (a hitch, a dragged window) are clipped, not caught up
+public:
+    FixedStep();
+    void setRate(int rate_hz);
+    uint64_t getStepNs(void) const;
+    int advance(uint64_t ticks_ns); // monotonic ns, returns the number of steps to run for this frame
+    float getAlpha(void) const; // 0..1 between the state before and after the last step
+};
+
+#endif // FIXED_STEP_H
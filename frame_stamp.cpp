@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "frame_stamp.h"
+
+#include <cstddef>
+#include <cstring>
+
+static const uint8_t stamp_marker[3] = {'m', 's', 1};
+static const uint64_t time_mask = (1ULL << 56) - 1;
+
+// the three pad bools of a struct are written as one 3 byte field
+static_assert(offsetof(r_head_data, _pad1) == offsetof(r_head_data, _pad0) + 1
+              && offsetof(r_head_data, _pad2) == offsetof(r_head_data, _pad0) + 2, "head padding is contiguous");
+static_assert(offsetof(r_remote_controller_data, _pad1) == offsetof(r_remote_controller_data, _pad0) + 1
+              && offsetof(r_remote_controller_data, _pad2) == offsetof(r_remote_controller_data, _pad0) + 2,
+              "controller padding is contiguous");
+
+void writeFrameStamp(r_remote_data& frame, uint32_t seq, uint64_t realtime_ns) {
+    frame.head.views[0]._pad = seq;
+    frame.head.views[1]._pad = static_cast<uint32_t>(realtime_ns);
+    uint8_t high[3] = {static_cast<uint8_t>(realtime_ns >> 32), static_cast<uint8_t>(realtime_ns >> 40),
+                       static_cast<uint8_t>(realtime_ns >> 48)};
+    memcpy(&frame.head._pad0, high, 3); // bytes, not bools, Monado never reads them
+    memcpy(&frame.left._pad0, stamp_marker, 3);
+}
+
+bool readFrameStamp(const r_remote_data& frame, uint64_t now_realtime_ns, FrameStamp& stamp) {
+    if (memcmp(&frame.left._pad0, stamp_marker, 3) != 0) {
+        return false;
+    }
+    uint8_t high[3];
+    memcpy(high, &frame.head._pad0, 3);
+    uint64_t low56 = frame.head.views[1]._pad | uint64_t(high[0]) << 32 | uint64_t(high[1]) << 40
+                     | uint64_t(high[2]) << 48;
+    // 56 bits of ns wrap every ~833 days, take the value closest to the receiver's clock
+    uint64_t send_ns = (now_realtime_ns & ~time_mask) | low56;
+    if (send_ns > now_realtime_ns + (time_mask >> 1)) {
+        send_ns -= time_mask + 1;
+    } else if (send_ns + (time_mask >> 1) < now_realtime_ns) {
+        send_ns += time_mask + 1;
+    }
+    stamp.seq = frame.head.views[0]._pad;
+    stamp.send_ns = send_ns;
+    return true;
+}
+
+void clearFrameStamp(r_remote_data& frame) {
+    frame.head.views[0]._pad = 0;
+    frame.head.views[1]._pad = 0;
+    frame.head._pad0 = frame.head._pad1 = frame.head._pad2 = false;
+    frame.left._pad0 = frame.left._pad1 = frame.left._pad2 = false;
+}
+
+void writeFrameInput(r_remote_data& frame, uint32_t input_id) {
+    uint8_t id[3] = {static_cast<uint8_t>(input_id), static_cast<uint8_t>(input_id >> 8),
+                     static_cast<uint8_t>(input_id >> 16)};
+    memcpy(&frame.right._pad0, id, 3);
+}
+
+uint32_t readFrameInput(const r_remote_data& frame) {
+    uint8_t id[3];
+    memcpy(id, &frame.right._pad0, 3);
+    return id[0] | uint32_t(id[1]) << 8 | uint32_t(id[2]) << 16;
+}
+
+FrameStampTracker::FrameStampTracker() {
+    reset();
+}
+
+void FrameStampTracker::add(const r_remote_data& frame, uint64_t now_realtime_ns) {
+    received++;
+    FrameStamp stamp;
+    if (!readFrameStamp(frame, now_realtime_ns, stamp)) {
+        unstamped++;
+        return;
+    }
+    if (now_realtime_ns >= stamp.send_ns) {
+        latency.record(now_realtime_ns - stamp.send_ns);
+    } else {
+        latency.record(0); // clocks of the two hosts disagree
+    }
+    if (!started) {
+        started = true;
+        next_seq = stamp.seq + 1;
+        return;
+    }
+    int32_t diff = static_cast<int32_t>(stamp.seq - next_seq); // wraps like the sequence
+    if (diff >= 0) {
+        lost += static_cast<uint32_t>(diff);
+        next_seq = stamp.seq + 1;
+    } else {
+        reordered++; // counted as lost when the gap was seen
+        if (lost > 0) {
+            lost--;
+        }
+    }
+}
+
+void FrameStampTracker::reset(void) {
+    started = false;
+    next_seq = 0;
+    received = 0;
+    unstamped = 0;
+    lost = 0;
+    reordered = 0;
+    latency.reset();
+}
+
+uint64_t FrameStampTracker::getReceived(void) const {
+    return received;
+}
+
+uint64_t FrameStampTracker::getUnstamped(void) const {
+    return unstamped;
+}
+
+uint64_t FrameStampTracker::getLost(void) const {
+    return lost;
+}
+
+uint64_t FrameStampTracker::getReordered(void) const {
+    return reordered;
+}
+
+const LatencyHistogram& FrameStampTracker::getLatency(void) const {
+    return latency;
+}
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef FRAME_STAMP_H
+#define FRAME_STAMP_H
+
+#include "structs.h"
+#include "latency_histogram.h"
+
+#include <cstdint>
+
+/* Sequence number and send time in padding that Monado never reads, the frame size stays the same:
+   views[0]._pad      sequence number
+   views[1]._pad      send time, CLOCK_REALTIME ns, low 32 bits
+   head._pad0.._pad2  send time, bits 32..55
+   left._pad0.._pad2  marker "ms" + format version
+   right._pad0.._pad2 input id of the latency benchmark, 0 outside of it */
+struct FrameStamp {
+    uint32_t seq;
+    uint64_t send_ns; // CLOCK_REALTIME
+};
+
+void writeFrameStamp(r_remote_data& frame, uint32_t seq, uint64_t realtime_ns);
+bool readFrameStamp(const r_remote_data& frame, uint64_t now_realtime_ns, FrameStamp& stamp); // false if not stamped
+void clearFrameStamp(r_remote_data& frame);
+void writeFrameInput(r_remote_data& frame, uint32_t input_id); // 24 bits, first frame computed after that input
+uint32_t readFrameInput(const r_remote_data& frame);
+
+// Receiver side accounting of loss, reordering and one-way latency from stamped frames
+class FrameStampTracker {
+    bool started;
+    uint32_t next_seq;
+    uint64_t received;
+    uint64_t unstamped;
+    uint64_t lost; // gaps in the sequence, reduced again when a late frame arrives
+    uint64_t reordered;
+    LatencyHistogram latency; // ns, needs synchronized clocks across hosts
+
+public:
+    FrameStampTracker();
+    void add(const r_remote_data& frame, uint64_t now_realtime_ns);
+    void reset(void);
+    uint64_t getReceived(void) const;
+    uint64_t getUnstamped(void) const;
+    uint64_t getLost(void) const;
+    uint64_t getReordered(void) const;
+    const LatencyHistogram& getLatency(void) const;
+};
+
+#endif // FRAME_STAMP_H
@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "impairment.h"
+#include "tx_timestamps.h"
+
+#include <algorithm>
+#include <cmath>
+
+static ImpairmentProfile makeProfile(float latency, float jitter, LatencyDistribution distribution,
+                                     float stall_interval, float stall, float bandwidth) {
+    ImpairmentProfile p;
+    p.enabled = true;
+    p.latency_ms = latency;
+    p.jitter_ms = jitter;
+    p.distribution = distribution;
+    p.stall_interval_ms = stall_interval;
+    p.stall_ms = stall;
+    p.bandwidth_kbps = bandwidth;
+    return p;
+}
+
+static const ImpairmentPreset presets[] = {
+    {"Off", ImpairmentProfile{}},
+    {"LAN (1 ms)", makeProfile(1.0f, 0.2f, dist_normal, 0.0f, 0.0f, 0.0f)},
+    {"Good Wi-Fi (4 ms, jitter 2 ms)", makeProfile(4.0f, 2.0f, dist_normal, 0.0f, 0.0f, 0.0f)},
+    {"Busy Wi-Fi (8 ms, long tail, 30 ms stalls)", makeProfile(8.0f, 10.0f, dist_pareto, 2000.0f, 30.0f, 0.0f)},
+    {"Cellular (40 ms, jitter 15 ms, 200 ms stalls)", makeProfile(40.0f, 15.0f, dist_normal, 5000.0f, 200.0f, 0.0f)},
+    {"Slow link (1 Mbit/s)", makeProfile(2.0f, 0.0f, dist_constant, 0.0f, 0.0f, 1000.0f)},
+};
+
+size_t impairmentPresetCount(void) {
+    return sizeof(presets) / sizeof(presets[0]);
+}
+
+const ImpairmentPreset& impairmentPresetAt(size_t index) {
+    return presets[std::min(index, impairmentPresetCount() - 1)];
+}
+
+ImpairmentProfile impairmentFromConfig(const Config& config) {
+    ImpairmentProfile p;
+    p.enabled = config.impair_enabled;
+    p.latency_ms = std::max(config.impair_latency_ms, 0.0f);
+    p.jitter_ms = std::max(config.impair_jitter_ms, 0.0f);
+    p.distribution = config.impair_distribution;
+    p.stall_interval_ms = std::max(config.impair_stall_interval_ms, 0.0f);
+    p.stall_ms = std::max(config.impair_stall_ms, 0.0f);
+    p.bandwidth_kbps = std::max(config.impair_bandwidth_kbps, 0.0f);
+    p.seed = static_cast<uint64_t>(config.impair_seed);
+    return p;
+}
+
+static std::chrono::steady_clock::duration fromMs(double ms) {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(ms));
+}
+
+Impairment::Impairment(size_t capacity) : queue(std::max<size_t>(capacity, 1)) {
+    head = 0;
+    count = 0;
+    frame_size = sizeof(r_remote_data);
+    delayed = 0;
+    overflow = 0;
+    rng.seed(profile.seed);
+}
+
+void Impairment::setProfile(const ImpairmentProfile& new_profile) {
+    bool restart = (new_profile.enabled && !profile.enabled) || new_profile.seed != profile.seed;
+    bool stalls_changed = new_profile.stall_interval_ms != profile.stall_interval_ms;
+    profile = new_profile;
+    if (restart) {
+        // same seed, same sequence of delays and stalls for the same input
+        rng.seed(profile.seed);
+        link_free = clock::time_point{};
+        next_stall = clock::time_point{};
+        stall_end = clock::time_point{};
+    } else if (stalls_changed) {
+        next_stall = clock::time_point{};
+    }
+}
+
+void Impairment::setFrameSize(size_t bytes) {
+    frame_size = bytes;
+}
+
+bool Impairment::isEnabled(void) {
+    return profile.enabled;
+}
+
+std::chrono::steady_clock::duration Impairment::sampleExponential(float mean_ms) {
+    std::exponential_distribution<double> dist(1.0 / mean_ms);
+    return fromMs(dist(rng));
+}
+
+std::chrono::steady_clock::duration Impairment::sampleDelay(void) {
+    double ms = profile.latency_ms;
+    double j = profile.jitter_ms;
+    if (j > 0.0) {
+        switch (profile.distribution) {
+        case dist_uniform:
+            ms += std::uniform_real_distribution<double>(-j, j)(rng);
+            break;
+        case dist_normal:
+            ms += std::normal_distribution<double>(0.0, j)(rng);
+            break;
+        case dist_pareto: {
+            // shape 3: mean scale / 2, rare delays of many times the scale
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            ms += j * (std::pow(1.0 - u, -1.0 / 3.0) - 1.0);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return fromMs(std::max(ms, 0.0));
+}
+
+void Impairment::push(const r_remote_data& frame, clock::time_point now, uint64_t origin_ns) {
+    if (count == queue.size()) {
+        overflow++; // like a full router queue, the newest frame is lost
+        return;
+    }
+    clock::time_point release = now + sampleDelay();
+    if (profile.stall_interval_ms > 0.0f && profile.stall_ms > 0.0f) {
+        if (next_stall == clock::time_point{}) {
+            next_stall = now + sampleExponential(profile.stall_interval_ms);
+        }
+        while (now >= next_stall) { // a stall started since the previous frame
+            stall_end = next_stall + fromMs(profile.stall_ms);
+            next_stall = stall_end + sampleExponential(profile.stall_interval_ms);
+        }
+        if (now < stall_end) {
+            release = std::max(release, stall_end); // everything queued in the stall leaves as a burst
+        }
+    }
+    if (profile.bandwidth_kbps > 0.0f) {
+        auto transmit = fromMs(frame_size * 8.0 / profile.bandwidth_kbps);
+        link_free = std::max(link_free, release) + transmit;
+        release = link_free;
+    }
+    release = std::max(release, last_release); // a TCP stream never reorders
+    last_release = release;
+    Entry& entry = queue[(head + count) % queue.size()];
+    entry.frame = frame;
+    entry.release = release;
+    entry.origin_ns = origin_ns ? origin_ns : realtimeNs();
+    count++;
+    delayed++;
+}
+
+bool Impairment::pop(clock::time_point now, r_remote_data& frame, uint64_t& origin_ns) {
+    if (count == 0 || queue[head].release > now) {
+        return false;
+    }
+    return popAny(frame, origin_ns);
+}
+
+bool Impairment::popAny(r_remote_data& frame, uint64_t& origin_ns) {
+    if (count == 0) {
+        return false;
+    }
+    frame = queue[head].frame;
+    origin_ns = queue[head].origin_ns;
+    head = (head + 1) % queue.size();
+    count--;
+    return true;
+}
+
+std::chrono::steady_clock::time_point Impairment::nextRelease(void) {
+    return count == 0 ? clock::time_point::max() : queue[head].release;
+}
+
+size_t Impairment::getQueued(void) {
+    return count;
+}
+
+uint64_t Impairment::getDelayed(void) {
+    return delayed;
+}
+
+uint64_t Impairment::getOverflow(void) {
+    return overflow;
+}
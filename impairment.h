@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef IMPAIRMENT_H
+#define IMPAIRMENT_H
+
+#include "structs.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+// Emulated network between the pose source and the socket, like netem but without root
+struct ImpairmentProfile {
+    bool enabled = false;
+    float latency_ms = 0.0f; // base one-way delay
+    float jitter_ms = 0.0f; // spread of the delay, see LatencyDistribution
+    LatencyDistribution distribution = dist_uniform;
+    float stall_interval_ms = 0.0f; // mean time between burst stalls, 0 disables them
+    float stall_ms = 0.0f; // how long a stall holds every frame back
+    float bandwidth_kbps = 0.0f; // link rate, 0 is unlimited
+    uint64_t seed = 1;
+};
+
+// preset profiles for the UI, index 0 is "off"
+struct ImpairmentPreset {
+    const char* name;
+    ImpairmentProfile profile;
+};
+size_t impairmentPresetCount(void);
+const ImpairmentPreset& impairmentPresetAt(size_t index);
+ImpairmentProfile impairmentFromConfig(const Config& config);
+
+// Frames wait in a preallocated FIFO until their release time, release times never go backwards like in TCP
+class Impairment {
+    using clock = std::chrono::steady_clock;
+    struct Entry {
+        r_remote_data frame;
+        clock::time_point release;
+        uint64_t origin_ns; // CLOCK_REALTIME of push(), the emulated delay shows up in frame stamps
+    };
+    ImpairmentProfile profile;
+    std::vector<Entry> queue; // ring buffer, never grows
+    size_t head;
+    size_t count;
+    std::mt19937_64 rng;
+    clock::time_point last_release;
+    clock::time_point link_free; // bandwidth cap: when the emulated link finished the previous frame
+    size_t frame_size; // bytes the bandwidth cap charges per frame
+    clock::time_point next_stall; // start of the next burst stall
+    clock::time_point stall_end;
+    uint64_t delayed;
+    uint64_t overflow;
+
+    clock::duration sampleDelay(void);
+    clock::duration sampleExponential(float mean_ms);
+public:
+    explicit Impairment(size_t capacity = 4096);
+    void setProfile(const ImpairmentProfile& new_profile); // reseeds when the seed changes or on enabling
+    void setFrameSize(size_t bytes); // WireProtocol::frame_size of the active protocol
+    bool isEnabled(void);
+    void push(const r_remote_data& frame, clock::time_point now, uint64_t origin_ns = 0); // 0: now
+    bool pop(clock::time_point now, r_remote_data& frame, uint64_t& origin_ns); // next frame whose release time has come
+    bool popAny(r_remote_data& frame, uint64_t& origin_ns); // flushes the queue when the emulator is turned off
+    clock::time_point nextRelease(void); // time_point::max() if empty
+    size_t getQueued(void);
+    uint64_t getDelayed(void);
+    uint64_t getOverflow(void);
+};
+
+#endif // IMPAIRMENT_H
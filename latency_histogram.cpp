@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram() {
+    counts.assign((64 - sub_bucket_bits + 1) * sub_bucket_count, 0);
+    reset();
+}
+
+/* Values below sub_bucket_count are exact, above that every power of two gets sub_bucket_count buckets */
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < sub_bucket_count) {
+        return static_cast<size_t>(value);
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int exponent = msb - sub_bucket_bits + 1;
+    uint64_t top = value >> (exponent - 1); // in [sub_bucket_count, 2 * sub_bucket_count)
+    return exponent * sub_bucket_count + (top - sub_bucket_count);
+}
+
+uint64_t LatencyHistogram::bucketUpperValue(size_t index) {
+    uint64_t exponent = index / sub_bucket_count;
+    uint64_t sub = index % sub_bucket_count;
+    if (exponent == 0) {
+        return sub;
+    }
+    return ((sub_bucket_count + sub + 1) << (exponent - 1)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    counts[bucketIndex(value)]++;
+    total++;
+    min_value = std::min(min_value, value);
+    max_value = std::max(max_value, value);
+    sum += static_cast<double>(value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < counts.size(); i++) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    min_value = std::min(min_value, other.min_value);
+    max_value = std::max(max_value, other.max_value);
+    sum += other.sum;
+}
+
+void LatencyHistogram::reset(void) {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    min_value = UINT64_MAX;
+    max_value = 0;
+    sum = 0.0;
+}
+
+uint64_t LatencyHistogram::getCount(void) const {
+    return total;
+}
+
+uint64_t LatencyHistogram::getMin(void) const {
+    return total ? min_value : 0;
+}
+
+uint64_t LatencyHistogram::getMax(void) const {
+    return max_value;
+}
+
+double LatencyHistogram::getMean(void) const {
+    return total ? sum / total : 0.0;
+}
+
+/* Highest value equivalent to the requested rank, clamped to the recorded maximum */
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * total));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(bucketUpperValue(i), max_value);
+        }
+    }
+    return max_value;
+}
+
+LatencySummary LatencyHistogram::getSummary(void) const {
+    LatencySummary s;
+    s.count = total;
+    s.p50_us = getPercentile(50.0) / 1000.0;
+    s.p99_us = getPercentile(99.0) / 1000.0;
+    s.max_us = getMax() / 1000.0;
+    return s;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> LatencyHistogram::getBuckets(void) const {
+    std::vector<std::pair<uint64_t, uint64_t>> result;
+    for (size_t i = 0; i < counts.size(); i++) {
+        if (counts[i] > 0) {
+            result.emplace_back(std::min(bucketUpperValue(i), max_value), counts[i]);
+        }
+    }
+    return result;
+}
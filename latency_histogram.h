@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include "structs.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// HDR-style histogram: log2 buckets split into linear sub-buckets, ~3% relative error over the full uint64 range
+class LatencyHistogram {
+    static const int sub_bucket_bits = 5;
+    static const uint64_t sub_bucket_count = 1ULL << sub_bucket_bits;
+
+    std::vector<uint64_t> counts;
+    uint64_t total;
+    uint64_t min_value;
+    uint64_t max_value;
+    double sum;
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperValue(size_t index);
+public:
+    LatencyHistogram();
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+    void reset(void);
+    uint64_t getCount(void) const;
+    uint64_t getMin(void) const;
+    uint64_t getMax(void) const;
+    double getMean(void) const;
+    uint64_t getPercentile(double percentile) const; // percentile in 0..100
+    LatencySummary getSummary(void) const; // values recorded in ns, summary in us
+    std::vector<std::pair<uint64_t, uint64_t>> getBuckets(void) const; // (highest value, count) of non-empty buckets
+};
+
+#endif // LATENCY_HISTOGRAM_H
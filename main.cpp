@@ -6,12 +6,18 @@
  * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
  */
 
-#include "data_sender.h"
+#include "sender_thread.h"
 #include "structs.h"
 #include "movement.h"
 #include "math_helper.h"
 #include "main_window.h"
 #include "settings.h"
+#include "metrics_exporter.h"
+#include "frame_stamp.h"
+#include "tx_timestamps.h"
+#include "input_latency_probe.h"
+#include "jitter_bench.h"
+#include "fixed_step.h"
 
 #include <SDL3/SDL_main.h>
 
@@ -19,21 +25,59 @@
 #include "imgui_impl_sdl3.h"
 #include "imgui_impl_sdlgpu3.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <unistd.h>
 #include <vector>
 
-int main()
+int main(int argc, char* argv[])
 {
     auto config_dir = getConfigDir();
     auto config = loadConfig(config_dir);
 
+    /* --latency-bench [seconds] [report.json]: synthetic key presses, input to receive latency at a loopback sink
+       --jitter-bench [seconds] [report.json]: loop and send period jitter, with --cpu-stress N and --io-stress N threads
+       --present vsync|mailbox|immediate: swapchain present mode, to compare it in the jitter benchmark */
+    bool latency_bench = false;
+    bool jitter_bench = false;
+    int bench_seconds = 10;
+    std::string bench_report;
+    StressOptions stress;
+    std::string present_name = "vsync";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--latency-bench") == 0 || strcmp(argv[i], "--jitter-bench") == 0) {
+            latency_bench = latency_bench || strcmp(argv[i], "--latency-bench") == 0;
+            jitter_bench = jitter_bench || strcmp(argv[i], "--jitter-bench") == 0;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                bench_seconds = std::max(1, std::atoi(argv[++i]));
+            }
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                bench_report = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--cpu-stress") == 0 && i + 1 < argc) {
+            stress.cpu_threads = std::max(0, std::atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--io-stress") == 0 && i + 1 < argc) {
+            stress.io_threads = std::max(0, std::atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--present") == 0 && i + 1 < argc) {
+            present_name = argv[++i];
+        }
+    }
+    if (latency_bench && jitter_bench) {
+        std::cerr << "Run --latency-bench and --jitter-bench separately" << std::endl;
+        return -1;
+    }
+    if (bench_report.empty()) {
+        bench_report = jitter_bench ? "loop-jitter.json" : "input-latency.json";
+    }
+
     std::vector<SDL_Gamepad*> gamepads;
 
     /* SDL window part */
     bool running = true;
-    Uint64 old_ticks = 0;
     int width = 640;
     int height = 300;
     float base_mouse_x = 0.0f;
@@ -75,7 +119,21 @@ int main()
         std::cerr << "Error: SDL_ClaimWindowForGPUDevice(): " << SDL_GetError() << std::endl;
         return -1;
     }
-    SDL_SetGPUSwapchainParameters(gpu_device, window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, SDL_GPU_PRESENTMODE_VSYNC);
+    SDL_GPUPresentMode present_mode = SDL_GPU_PRESENTMODE_VSYNC;
+    if (present_name == "mailbox") {
+        present_mode = SDL_GPU_PRESENTMODE_MAILBOX;
+    } else if (present_name == "immediate") {
+        present_mode = SDL_GPU_PRESENTMODE_IMMEDIATE;
+    } else if (present_name != "vsync") {
+        std::cerr << "Unknown present mode " << present_name << ", using vsync" << std::endl;
+        present_name = "vsync";
+    }
+    if (!SDL_WindowSupportsGPUPresentMode(gpu_device, window, present_mode)) {
+        std::cerr << "Present mode " << present_name << " is not supported, using vsync" << std::endl;
+        present_mode = SDL_GPU_PRESENTMODE_VSYNC; // always available
+        present_name = "vsync";
+    }
+    SDL_SetGPUSwapchainParameters(gpu_device, window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, present_mode);
 
     /* ImGui graphical interface part */
     // Setup Dear ImGui context
@@ -113,11 +171,65 @@ int main()
     rightMov->updateConfigValues(config.controller_lin_vel, config.controller_ang_vel,
                                  config.mouse_sens, config.gamepad_axis_sens, config.gamepad_dead_zone);
 
-    /* TCP data part */
-    std::unique_ptr<DataSender> dataSender = std::make_unique<DataSender>();
+    /* TCP data part, frames are sent from a separate thread at config.send_rate */
+    std::unique_ptr<SenderThread> senderThread = std::make_unique<SenderThread>();
+    MetricsExporter metrics;
+    senderThread->setConnectOptions(config.connect_timeout_ms, config.auto_reconnect);
+    if (senderThread->setProtocol(config.protocol_version) < 0) {
+        std::cerr << "Protocol version " << config.protocol_version << " is not supported, using "
+                  << defaultWireProtocol()->name << std::endl;
+        config.protocol_version = defaultWireProtocol()->version;
+    }
+    senderThread->setSendMode(config.send_mode, config.max_backlog_frames);
+    senderThread->setBackend(config.backend, config.uring_sqpoll);
+    senderThread->setTxTimestamps(config.tx_timestamps);
+    senderThread->setFrameStamps(config.frame_stamps);
+    senderThread->setTcpInfoInterval(config.tcp_info_interval_ms);
+    senderThread->setSendOnChange(config.send_on_change, deadBandFromConfig(config));
+    senderThread->setImpairment(impairmentFromConfig(config));
+    senderThread->setAdaptiveRate(config.adaptive_rate, rateControlFromConfig(config));
+    senderThread->start(config.send_rate);
+
+    InputLatencyProbe probe; // also the receiver of the jitter benchmark
+    JitterBench jitterBench;
+    uint32_t input_id = 0; // id of the newest input, goes into every frame
+    uint64_t input_origin = 0; // CLOCK_REALTIME of an input not yet published
+    uint64_t inputs_sent = 0;
+    bool key_down = false;
+    Uint64 next_input_ns = 0;
+    Uint64 bench_end_ns = 0;
+    if (latency_bench || jitter_bench) {
+        if (probe.start() < 0) {
+            return -1;
+        }
+        // emulated release times and dead-band suppressed frames would be measured instead of the real path
+        config.impair_enabled = false;
+        config.send_on_change = false;
+        senderThread->setImpairment(impairmentFromConfig(config)); // before the first frame, the loop applies it too
+        senderThread->setSendOnChange(config.send_on_change, deadBandFromConfig(config));
+        config.server_ip = probe.getAddress(); // not saved, the benchmarks leave config.txt alone
+        senderThread->requestConnect(config.server_ip);
+        bench_end_ns = SDL_GetTicksNS() + bench_seconds * 1000000000ULL;
+    }
+    if (latency_bench) {
+        config.frame_stamps = true;
+        senderThread->setFrameStamps(true);
+        mouse_kb_grabbed = true; // keys go to Movement, the mouse itself is not grabbed
+        std::cout << "Latency benchmark for " << bench_seconds << " s, report: " << bench_report << std::endl;
+    }
+    if (jitter_bench) {
+        config.adaptive_rate = false; // the send period is measured against config.send_rate
+        jitterBench.reserve(bench_seconds, config.send_rate);
+        if (jitterBench.startStress(stress) < 0) {
+            return -1;
+        }
+        senderThread->setSendRecorder(&jitterBench.getSend());
+        std::cout << "Jitter benchmark for " << bench_seconds << " s, " << stress.cpu_threads << " CPU and "
+                  << stress.io_threads << " IO stress threads, present mode " << present_name
+                  << ", report: " << bench_report << std::endl;
+    }
     r_remote_data data{};
     data.header = R_HEADER_VALUE;
-    r_remote_data old_data{}; // for velocity calculation
     // set some valid value for starting orientation
     const xrt_quat default_quat = {0.0f, 0.0f, 0.0f, 1.0f};
 
@@ -139,13 +251,42 @@ int main()
     data.left.active = true;
     data.right.active =  true;
 
+    /* Poses advance in fixed steps of 1 / config.sim_rate, whatever the GUI frame rate is */
+    FixedStep fixedStep;
+    fixedStep.setRate(config.sim_rate);
+    hmdMov->setFixedStep(fixedStep.getStepNs());
+    leftMov->setFixedStep(fixedStep.getStepNs());
+    rightMov->setFixedStep(fixedStep.getStepNs());
+    // world poses before and after the last step, frames are interpolated between them
+    xrt_pose step_head[2] = {data.head.center, data.head.center};
+    xrt_pose step_left[2] = {poseMult(data.head.center, left_rel), poseMult(data.head.center, left_rel)};
+    xrt_pose step_right[2] = {poseMult(data.head.center, right_rel), poseMult(data.head.center, right_rel)};
+
     while (running) {
         /* SDL event and data sending*/
 
-        Uint64 ticks = SDL_GetTicks();
-        old_ticks = ticks; // End of the workaround
-
-        hmdMov->updateTicks(ticks);
+        if (jitter_bench && senderThread->isConnected()) {
+            jitterBench.getLoop().mark(); // one period per iteration, render and present included
+            if (SDL_GetTicksNS() >= bench_end_ns) {
+                running = false;
+            }
+        }
+        if (latency_bench && senderThread->isConnected()) {
+            Uint64 now_ns = SDL_GetTicksNS();
+            if (now_ns >= bench_end_ns) {
+                running = false;
+            } else if (now_ns >= next_input_ns) {
+                // alternate press and release, SDL stamps the event when it is pushed
+                key_down = !key_down;
+                SDL_Event input{};
+                input.type = key_down ? SDL_EVENT_KEY_DOWN : SDL_EVENT_KEY_UP;
+                input.key.key = SDLK_W;
+                input.key.down = key_down;
+                SDL_PushEvent(&input);
+                inputs_sent++;
+                next_input_ns = now_ns + 20000000ULL;
+            }
+        }
 
         SDL_Event event;
         while (SDL_PollEvent(&event)) {  // poll until all events are handled
@@ -180,6 +321,12 @@ int main()
                         mouse_kb_grabbed = false;
                     }
                 }
+                if (latency_bench && (event.type == SDL_EVENT_KEY_DOWN || event.type == SDL_EVENT_KEY_UP)) {
+                    // SDL event times are SDL_GetTicksNS(), frame stamps use CLOCK_REALTIME
+                    input_origin = realtimeNs() - (SDL_GetTicksNS() - event.key.timestamp);
+                    input_id = input_id % 0xFFFFFF + 1; // 24 bits, 0 means no input
+                    writeFrameInput(data, input_id);
+                }
                 if (mouse_kb_grabbed){
                     SDL_Keymod mod = SDL_GetModState();  // Get the current key modifier state for the keyboard (SHIFT, CTRL etc.)
                     if (mod & SDL_KMOD_LSHIFT) {
@@ -275,21 +422,39 @@ int main()
                 data.right.trigger_click = false;
             }
         }
-        // HMD, center is a xrt_pose
-        hmdMov->updatePose(data.head.center);
-
-        // controllers following HMD
-        leftMov->updatePose(left_rel);
-        data.left.pose = poseMult(data.head.center, left_rel);
-        leftMov->updateVelocity(data.left.pose, old_data.left.pose,
-                                data.left.linear_velocity, data.left.angular_velocity);
-        rightMov->updatePose(right_rel);
-        data.right.pose = poseMult(data.head.center, right_rel);
-        rightMov->updateVelocity(data.right.pose, old_data.right.pose,
-                                data.right.linear_velocity, data.right.angular_velocity);
-
-        /* Sending all the data */
-        dataSender->sendData(data);
+        /* Run the simulation steps due since the last frame. Keys and sticks hold for all of them,
+           the mouse delta is split between them and kept for the next frame if none is due. */
+        int steps = fixedStep.advance(SDL_GetTicksNS());
+        hmdMov->beginSteps(steps);
+        leftMov->beginSteps(steps);
+        rightMov->beginSteps(steps);
+        for (int i = 0; i < steps; i++) {
+            step_head[0] = step_head[1];
+            step_left[0] = step_left[1];
+            step_right[0] = step_right[1];
+            // HMD, center is a xrt_pose
+            hmdMov->updatePose(step_head[1]);
+            // controllers following HMD
+            leftMov->updatePose(left_rel);
+            step_left[1] = poseMult(step_head[1], left_rel);
+            rightMov->updatePose(right_rel);
+            step_right[1] = poseMult(step_head[1], right_rel);
+        }
+        if (steps > 0) {
+            // velocities over the last step, the same at any frame rate
+            leftMov->updateVelocity(step_left[1], step_left[0],
+                                    data.left.linear_velocity, data.left.angular_velocity);
+            rightMov->updateVelocity(step_right[1], step_right[0],
+                                     data.right.linear_velocity, data.right.angular_velocity);
+        }
+        float alpha = fixedStep.getAlpha();
+        data.head.center = poseInterpolate(step_head[0], step_head[1], alpha);
+        data.left.pose = poseInterpolate(step_left[0], step_left[1], alpha);
+        data.right.pose = poseInterpolate(step_right[0], step_right[1], alpha);
+
+        /* Hand the newest frame over to the sender thread */
+        senderThread->publish(data, input_origin);
+        input_origin = 0;
 
         /* ImGui rendering */
 
@@ -300,7 +465,30 @@ int main()
 
         /* Main Window creation (every frame)*/
         WindowState w_state{};
-        w_state.connect_button_clicked = dataSender->isSocketOpened();
+        w_state.connect_button_clicked = senderThread->isConnectRequested();
+        w_state.conn_state = senderThread->getState();
+        w_state.retry_in_ms = senderThread->getRetryDelay();
+        w_state.stats = senderThread->getStats();
+        w_state.tx_latency = senderThread->getTxLatency();
+        w_state.tcp_info = senderThread->getTcpInfo();
+        w_state.endpoints = senderThread->getEndpoints();
+        w_state.rate_history = senderThread->getRateHistory();
+        metrics.setPath(config.metrics_file);
+        if (metrics.isDue()) {
+            metrics.begin();
+            if (w_state.endpoints.empty()) {
+                metrics.addConnection(w_state.conn_state, w_state.stats);
+                metrics.addTcpInfo(w_state.tcp_info);
+                metrics.addTxLatency(w_state.tx_latency);
+            }
+            for (const auto& endpoint : w_state.endpoints) {
+                std::string labels = metrics.endpointLabel(endpoint.address);
+                metrics.addConnection(endpoint.state, endpoint.stats, labels);
+                metrics.addTcpInfo(endpoint.tcp_info, labels);
+                metrics.addTxLatency(endpoint.tx_latency, labels);
+            }
+            metrics.commit();
+        }
         w_state.grab_button_clicked = mouse_kb_grabbed;
         w_state.iCons = inputConsumer;
         w_state.config = config;
@@ -317,11 +505,12 @@ int main()
 
         drawMainWindow(w_state); // window with all widgets
 
-        if (w_state.connect_button_clicked && !dataSender->isSocketOpened()) {
-            dataSender->openSocket(w_state.config.server_ip);
+        // only a click in this frame counts, the sender thread may have given up since the state was read
+        if (w_state.connect_pressed) {
+            senderThread->requestConnect(w_state.config.server_ip, w_state.config.standby_ip);
         }
-        if (!w_state.connect_button_clicked && dataSender->isSocketOpened()) {
-            dataSender->closeSocket();
+        if (w_state.disconnect_pressed) {
+            senderThread->requestDisconnect();
         }
 
         if (mouse_kb_grabbed != w_state.grab_button_clicked) {
@@ -333,7 +522,22 @@ int main()
         }
 
         config = w_state.config;
-
+        senderThread->setRate(config.send_rate);
+        senderThread->setConnectOptions(config.connect_timeout_ms, config.auto_reconnect);
+        senderThread->setProtocol(config.protocol_version);
+        senderThread->setSendMode(config.send_mode, config.max_backlog_frames);
+        senderThread->setBackend(config.backend, config.uring_sqpoll);
+        senderThread->setTxTimestamps(config.tx_timestamps);
+        senderThread->setFrameStamps(config.frame_stamps);
+        senderThread->setTcpInfoInterval(config.tcp_info_interval_ms);
+        senderThread->setSendOnChange(config.send_on_change, deadBandFromConfig(config));
+        senderThread->setImpairment(impairmentFromConfig(config));
+        senderThread->setAdaptiveRate(config.adaptive_rate, rateControlFromConfig(config));
+
+        fixedStep.setRate(config.sim_rate);
+        hmdMov->setFixedStep(fixedStep.getStepNs());
+        leftMov->setFixedStep(fixedStep.getStepNs());
+        rightMov->setFixedStep(fixedStep.getStepNs());
         hmdMov->updateConfigValues(config.hmd_lin_vel, config.hmd_ang_vel,
                                    config.mouse_sens, config.gamepad_axis_sens, config.gamepad_dead_zone);
         leftMov->updateConfigValues(config.controller_lin_vel, config.controller_ang_vel,
@@ -341,8 +545,6 @@ int main()
         rightMov->updateConfigValues(config.controller_lin_vel, config.controller_ang_vel,
                                      config.mouse_sens, config.gamepad_axis_sens, config.gamepad_dead_zone);
 
-        old_data = data;
-
         // Rendering
         ImGui::Render();
         ImDrawData* draw_data = ImGui::GetDrawData();
@@ -377,8 +579,25 @@ int main()
         SDL_SubmitGPUCommandBuffer(command_buffer);
     }
 
-    /* Save configuration */
-    saveConfig(config_dir, config);
+    senderThread->stop();
+
+    if (jitter_bench) {
+        senderThread->setSendRecorder(nullptr);
+        jitterBench.stopStress();
+        probe.stop();
+        jitterBench.printSummary(config.send_rate);
+        jitterBench.writeReport(bench_report, config.send_rate, present_name);
+    } else if (latency_bench) {
+        probe.stop();
+        LatencySummary l = probe.getSummary();
+        std::cout << "Input to receive: " << l.count << " of " << inputs_sent << " inputs, p50 " << l.p50_us
+                  << " us, p99 " << l.p99_us << " us, max " << l.max_us << " us" << std::endl;
+        probe.writeReport(bench_report, inputs_sent, config.send_rate);
+    }
+    if (!latency_bench && !jitter_bench) {
+        /* Save configuration, the benchmarks override some settings and must not store them */
+        saveConfig(config_dir, config);
+    }
 
     /* Terminate SDL and ImGui */
     for (const auto& gamepad : gamepads) {
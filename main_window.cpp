@@ -4,10 +4,14 @@
  */
 
 #include "main_window.h"
+#include "wire_protocol.h"
+#include "impairment.h"
 
 #include "imgui.h"
 #include "misc/cpp/imgui_stdlib.h"
 
+#include <cstdio>
+
 void drawMainWindow(WindowState& state) {
     ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
     ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
@@ -29,17 +33,41 @@ void drawMainWindow(WindowState& state) {
     } else {
         ImGui::Text("No gamepad found");
     }
-    ImGui::InputText( "monado-service IP", &state.config.server_ip);
+    ImGui::InputText( "monado-service address (comma separated host[:port] for several)", &state.config.server_ip);
     if (state.connect_button_clicked){
         if (ImGui::Button("Disconnect")){
             state.connect_button_clicked = false;
+            state.disconnect_pressed = true;
         }
     }
     else {
         if (ImGui::Button("Connect")){
             state.connect_button_clicked = true;
+            state.connect_pressed = true;
         }
     }
+    ImGui::SameLine();
+    if (state.conn_state == conn_connected) {
+        ImGui::Text("Connected");
+    } else if (state.conn_state == conn_connecting) {
+        ImGui::Text("Connecting...");
+    } else if (state.conn_state == conn_reconnect_wait) {
+        ImGui::Text("Server unavailable, retrying in %.1f s", state.retry_in_ms / 1000.0f);
+    } else {
+        ImGui::Text("Disconnected");
+    }
+    if (state.conn_state == conn_connected && state.tcp_info.valid && state.endpoints.empty()) {
+        const TcpInfoSample& t = state.tcp_info;
+        ImGui::SameLine();
+        ImGui::Text("| RTT %.2f +/- %.2f ms, cwnd %u, unacked %d B, retrans %u",
+                    t.rtt_us / 1000.0f, t.rtt_var_us / 1000.0f, t.cwnd, t.unacked_bytes, t.total_retrans);
+    }
+    ImGui::Checkbox("Reconnect automatically", &state.config.auto_reconnect);
+    ImGui::InputText("Warm standby address (optional, applied on connect)", &state.config.standby_ip);
+    if (state.stats.failovers > 0 || state.stats.on_standby) {
+        ImGui::Text("%s, %llu failovers, last took %.1f ms", state.stats.on_standby ? "On standby" : "On primary",
+                    (unsigned long long)state.stats.failovers, state.stats.failover_ms);
+    }
     if (state.grab_button_clicked) {
         ImGui::Button("Press Esc to release mouse and keyboard");
     } else {
@@ -56,5 +84,144 @@ void drawMainWindow(WindowState& state) {
     ImGui::SliderFloat("Mouse sensivity", &state.config.mouse_sens, 0.0f, 5.0f);
     ImGui::SliderFloat("Gamepad axis sensivity", &state.config.gamepad_axis_sens, 0.0f, 5.0f);
     ImGui::SliderFloat("Gamepad dead zone", &state.config.gamepad_dead_zone, 0.0f, 0.5f);
+    ImGui::SliderInt("Movement simulation rate (Hz)", &state.config.sim_rate, 60, 4000);
+    ImGui::SliderInt(state.config.adaptive_rate ? "Pose send rate at connect (Hz)" : "Pose send rate (Hz)",
+                     &state.config.send_rate, 30, 1000);
+    ImGui::Checkbox("Adapt send rate to the link", &state.config.adaptive_rate);
+    if (state.config.adaptive_rate) {
+        ImGui::DragIntRange2("Rate bounds (Hz)", &state.config.adaptive_min_rate, &state.config.adaptive_max_rate,
+                             1.0f, 10, 2000, "min %d", "max %d");
+        ImGui::SliderFloat("RTT rise treated as congestion (ms)", &state.config.adaptive_rtt_margin_ms, 1.0f, 100.0f);
+        if (!state.rate_history.empty()) {
+            char overlay[64];
+            snprintf(overlay, sizeof(overlay), "%d Hz, %llu cuts", state.stats.send_rate,
+                     (unsigned long long)state.stats.rate_decreases);
+            ImGui::PlotLines("Send rate", state.rate_history.data(), static_cast<int>(state.rate_history.size()), 0,
+                             overlay, 0.0f, static_cast<float>(state.config.adaptive_max_rate), ImVec2(0, 60));
+        }
+    }
+    ImGui::SliderInt("Connect timeout (ms)", &state.config.connect_timeout_ms, 100, 10000);
+    const WireProtocol* protocol = findWireProtocol(state.config.protocol_version);
+    if (ImGui::BeginCombo("Protocol", protocol ? protocol->name : "unsupported")) {
+        for (size_t i = 0; i < wireProtocolCount(); i++) {
+            const WireProtocol* p = wireProtocolAt(i);
+            if (ImGui::Selectable(p->name, p == protocol)) {
+                state.config.protocol_version = p->version;
+            }
+        }
+        ImGui::EndCombo();
+    }
+    const char* send_modes[] = {"Queue every frame", "Latest pose wins"};
+    int send_mode = state.config.send_mode;
+    if (ImGui::Combo("Send mode", &send_mode, send_modes, IM_ARRAYSIZE(send_modes))) {
+        state.config.send_mode = static_cast<SendMode>(send_mode);
+    }
+    if (state.config.send_mode == send_latest) {
+        ImGui::SliderInt("Max backlog (frames)", &state.config.max_backlog_frames, 1, 16);
+    }
+    const char* backends[] = {"BSD sockets", "io_uring"};
+    int backend = state.config.backend;
+    if (ImGui::Combo("Transport backend (applied on connect)", &backend, backends, IM_ARRAYSIZE(backends))) {
+        state.config.backend = static_cast<TransportBackend>(backend);
+    }
+    if (state.config.backend == backend_uring) {
+        ImGui::SameLine();
+        ImGui::Checkbox("SQPOLL", &state.config.uring_sqpoll);
+        if (state.conn_state == conn_connected && state.stats.backend != backend_uring) {
+            ImGui::Text("io_uring is not available, using BSD sockets");
+        }
+    }
+    ImGui::Checkbox("Send only on change", &state.config.send_on_change);
+    if (state.config.send_on_change) {
+        ImGui::SliderFloat("Dead-band position (mm)", &state.config.dead_band_pos_mm, 0.0f, 10.0f);
+        ImGui::SliderFloat("Dead-band angle (deg)", &state.config.dead_band_angle_deg, 0.0f, 2.0f);
+        ImGui::SliderFloat("Dead-band velocity", &state.config.dead_band_vel, 0.0f, 0.5f);
+        ImGui::SliderInt("Keepalive interval (ms)", &state.config.keepalive_ms, 10, 1000);
+    }
+    ImGui::Checkbox("Emulate network impairment", &state.config.impair_enabled);
+    if (state.config.impair_enabled) {
+        ImGui::SameLine();
+        int preset = state.config.impair_preset;
+        if (ImGui::BeginCombo("Profile", impairmentPresetAt(preset).name)) {
+            for (size_t i = 1; i < impairmentPresetCount(); i++) { // 0 is "Off", the checkbox does that
+                if (ImGui::Selectable(impairmentPresetAt(i).name, static_cast<int>(i) == preset)) {
+                    const ImpairmentProfile& p = impairmentPresetAt(i).profile;
+                    state.config.impair_preset = static_cast<int>(i);
+                    state.config.impair_latency_ms = p.latency_ms;
+                    state.config.impair_jitter_ms = p.jitter_ms;
+                    state.config.impair_distribution = p.distribution;
+                    state.config.impair_stall_interval_ms = p.stall_interval_ms;
+                    state.config.impair_stall_ms = p.stall_ms;
+                    state.config.impair_bandwidth_kbps = p.bandwidth_kbps;
+                }
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::SliderFloat("Latency (ms)", &state.config.impair_latency_ms, 0.0f, 500.0f);
+        ImGui::SliderFloat("Jitter (ms)", &state.config.impair_jitter_ms, 0.0f, 100.0f);
+        const char* distributions[] = {"Constant", "Uniform", "Normal", "Pareto (long tail)"};
+        int distribution = state.config.impair_distribution;
+        if (ImGui::Combo("Jitter distribution", &distribution, distributions, IM_ARRAYSIZE(distributions))) {
+            state.config.impair_distribution = static_cast<LatencyDistribution>(distribution);
+        }
+        ImGui::SliderFloat("Mean time between stalls (ms, 0 = none)", &state.config.impair_stall_interval_ms, 0.0f, 10000.0f);
+        ImGui::SliderFloat("Stall duration (ms)", &state.config.impair_stall_ms, 0.0f, 1000.0f);
+        ImGui::SliderFloat("Bandwidth (kbit/s, 0 = unlimited)", &state.config.impair_bandwidth_kbps, 0.0f, 10000.0f);
+        ImGui::InputInt("Seed", &state.config.impair_seed);
+        ImGui::Text("Emulator: %llu frames delayed, %d queued, %llu dropped (queue full)",
+                    (unsigned long long)state.stats.impaired, state.stats.impair_queued,
+                    (unsigned long long)state.stats.impair_overflow);
+    }
+    ImGui::Text("Frames sent: %llu, dropped: %llu, coalesced: %llu, suppressed: %llu, unsent+unacked: %d B",
+                (unsigned long long)state.stats.sent, (unsigned long long)state.stats.dropped,
+                (unsigned long long)state.stats.coalesced, (unsigned long long)state.stats.suppressed,
+                state.stats.backlog_bytes);
+    if (!state.endpoints.empty()) {
+        const char* state_names[] = {"Disconnected", "Connecting", "Connected", "Retrying"};
+        ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+        if (ImGui::BeginTable("endpoints", 7, flags)) {
+            ImGui::TableSetupColumn("Endpoint");
+            ImGui::TableSetupColumn("State");
+            ImGui::TableSetupColumn("Sent");
+            ImGui::TableSetupColumn("Dropped");
+            ImGui::TableSetupColumn("Unsent+unacked (B)");
+            ImGui::TableSetupColumn("RTT (ms)");
+            ImGui::TableSetupColumn("TX p99 (us)");
+            ImGui::TableHeadersRow();
+            for (const auto& endpoint : state.endpoints) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(endpoint.address.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%s%s", state_names[endpoint.state], endpoint.standby ? " (standby)" : "");
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)endpoint.stats.sent);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)endpoint.stats.dropped);
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", endpoint.stats.backlog_bytes);
+                ImGui::TableNextColumn();
+                if (endpoint.tcp_info.valid) {
+                    ImGui::Text("%.2f", endpoint.tcp_info.rtt_us / 1000.0f);
+                }
+                ImGui::TableNextColumn();
+                if (endpoint.tx_latency.enabled) {
+                    ImGui::Text("%.0f", endpoint.tx_latency.total.p99_us);
+                }
+            }
+            ImGui::EndTable();
+        }
+    }
+    ImGui::InputText("Metrics file (Prometheus textfile)", &state.config.metrics_file);
+    ImGui::Checkbox("Sequence numbers and send time in padding (for our own receivers)", &state.config.frame_stamps);
+    ImGui::Checkbox("Kernel TX timestamps", &state.config.tx_timestamps);
+    if (state.config.tx_timestamps && state.tx_latency.enabled) {
+        const TxLatencyStats& l = state.tx_latency;
+        ImGui::Text("p50/p99 us - process: %.0f/%.0f, socket+TCP: %.0f/%.0f, qdisc: %.0f/%.0f, to driver: %.0f/%.0f",
+                    l.user.p50_us, l.user.p99_us, l.stack.p50_us, l.stack.p99_us,
+                    l.qdisc.p50_us, l.qdisc.p99_us, l.total.p50_us, l.total.p99_us);
+        ImGui::Text("Acked by receiver p50/p99: %.0f/%.0f us (%llu frames)",
+                    l.ack.p50_us, l.ack.p99_us, (unsigned long long)l.total.count);
+    }
     ImGui::End();
 }
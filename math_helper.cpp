@@ -27,6 +27,20 @@ std::tuple<float, float, float> quatToYXZ(const xrt_quat& q) {
     return {yaw, pitch, roll};
 }
 
+/* Turns q by yaw about the world Y axis and by pitch and roll about its own X and Z axes, without Euler angles.
+   Computed in double, so rounding the result to float is the only error a step adds */
+struct xrt_quat quatRotateYXZ(const xrt_quat& q, float d_yaw, float d_pitch, float d_roll) {
+    glm::dquat q_glm = glm::dquat(q.w, q.x, q.y, q.z);
+    glm::dquat yaw = glm::angleAxis(static_cast<double>(d_yaw), glm::dvec3(0.0, 1.0, 0.0));
+    glm::dquat pitch = glm::angleAxis(static_cast<double>(d_pitch), glm::dvec3(1.0, 0.0, 0.0));
+    glm::dquat roll = glm::angleAxis(static_cast<double>(d_roll), glm::dvec3(0.0, 0.0, 1.0));
+    q_glm = glm::normalize(yaw * q_glm * pitch * roll);
+
+    xrt_quat result {static_cast<float>(q_glm.x), static_cast<float>(q_glm.y), static_cast<float>(q_glm.z),
+                     static_cast<float>(q_glm.w)};
+    return result;
+}
+
 // result is a vector rotated by a quaternion
 struct xrt_vec3 quatMultVec(const xrt_quat& q, const xrt_vec3& v) {
     const float qw = q.w, qx = q.x, qy = q.y, qz = q.z;
@@ -54,6 +68,20 @@ struct xrt_pose poseMult(const xrt_pose& a, const xrt_pose& b) {
     return result;
 }
 
+// t = 0 gives a, t = 1 gives b, orientation is slerped along the shortest arc
+struct xrt_pose poseInterpolate(const xrt_pose& a, const xrt_pose& b, float t) {
+    glm::quat qa = glm::quat(a.orientation.w, a.orientation.x, a.orientation.y, a.orientation.z);
+    glm::quat qb = glm::quat(b.orientation.w, b.orientation.x, b.orientation.y, b.orientation.z);
+    glm::quat q = glm::slerp(qa, qb, t);
+
+    xrt_pose result;
+    result.orientation = {q.x, q.y, q.z, q.w};
+    result.position = {a.position.x + (b.position.x - a.position.x) * t,
+                       a.position.y + (b.position.y - a.position.y) * t,
+                       a.position.z + (b.position.z - a.position.z) * t};
+    return result;
+}
+
 xrt_vec3 calculateAngularVel(const xrt_quat& q1, const xrt_quat& q2, float dt) {
     glm::quat q1_glm = glm::quat(q1.w, q1.x, q1.y, q1.z);
     glm::quat q2_glm = glm::quat(q2.w, q2.x, q2.y, q2.z);
@@ -13,8 +13,10 @@
 
 struct xrt_quat quatFromYXZ(float yaw, float pitch, float roll);
 std::tuple<float, float, float>  quatToYXZ(const xrt_quat& q);
+struct xrt_quat quatRotateYXZ(const xrt_quat& q, float d_yaw, float d_pitch, float d_roll);
 struct xrt_vec3 quatMultVec(const xrt_quat& q, const xrt_vec3& v);
 struct xrt_pose poseMult(const xrt_pose& a, const xrt_pose& b);
+struct xrt_pose poseInterpolate(const xrt_pose& a, const xrt_pose& b, float t);
 xrt_vec3 calculateAngularVel(const xrt_quat& q1, const xrt_quat& q2, float dt);
 
 #endif // MATH_HELPER_H
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "metrics_exporter.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+MetricsExporter::MetricsExporter() {
+    interval_ms = 1000;
+    failed = false;
+    next_write = std::chrono::steady_clock::now();
+}
+
+void MetricsExporter::setPath(const std::string& file_path) {
+    if (file_path != path) {
+        path = file_path;
+        failed = false;
+    }
+}
+
+bool MetricsExporter::isDue(void) {
+    if (path.empty() || failed) {
+        return false;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now < next_write) {
+        return false;
+    }
+    next_write = now + std::chrono::milliseconds(interval_ms);
+    return true;
+}
+
+void MetricsExporter::begin(void) {
+    out.str("");
+    out.clear();
+    described.clear();
+}
+
+void MetricsExporter::header(const char* name, const char* help, const char* type) {
+    if (!described.insert(name).second) {
+        return;
+    }
+    out << "# HELP remote_mndset_" << name << " " << help << "\n";
+    out << "# TYPE remote_mndset_" << name << " " << type << "\n";
+}
+
+/* Gauges keep every significant digit, the stream default of 6 would round 1234567 to 1.23457e+06 */
+void MetricsExporter::value(const char* name, double value, const std::string& labels) {
+    out << "remote_mndset_" << name;
+    if (!labels.empty()) {
+        out << "{" << labels << "}";
+    }
+    out << " " << std::setprecision(17) << value << "\n";
+}
+
+/* Counters are integers, printed exactly so rate() and increase() see every increment */
+void MetricsExporter::value(const char* name, uint64_t value, const std::string& labels) {
+    out << "remote_mndset_" << name;
+    if (!labels.empty()) {
+        out << "{" << labels << "}";
+    }
+    out << " " << value << "\n";
+}
+
+void MetricsExporter::gauge(const char* name, const char* help, double value, const std::string& labels) {
+    header(name, help, "gauge");
+    this->value(name, value, labels);
+}
+
+void MetricsExporter::counter(const char* name, const char* help, uint64_t value, const std::string& labels) {
+    header(name, help, "counter");
+    this->value(name, value, labels);
+}
+
+void MetricsExporter::addConnection(ConnectionState state, const SenderStats& stats, const std::string& labels) {
+    gauge("connection_state", "0 disconnected, 1 connecting, 2 connected, 3 waiting to reconnect", state, labels);
+    counter("frames_sent_total", "Frames fully written to the socket", stats.sent, labels);
+    counter("frames_dropped_total", "Frames replaced by a newer one before being sent", stats.dropped, labels);
+    counter("frames_coalesced_total", "Sends that superseded dropped frames", stats.coalesced, labels);
+    counter("partial_writes_total", "Short socket writes", stats.partial_writes, labels);
+    counter("frames_suppressed_total", "Frames skipped within the send-on-change dead-band", stats.suppressed, labels);
+    counter("keepalive_frames_total", "Unchanged frames resent as keepalive", stats.keepalives, labels);
+    counter("send_syscalls_total", "Syscalls made by the send path", stats.syscalls, labels);
+    gauge("socket_backlog_bytes", "Unsent and unacknowledged bytes in the socket (SIOCOUTQ)", stats.backlog_bytes, labels);
+    gauge("send_rate_hz", "Pose frames per second the sender thread runs at", stats.send_rate, labels);
+    counter("send_rate_decreases_total", "Multiplicative cuts of the adaptive send rate", stats.rate_decreases, labels);
+    gauge("on_standby", "1 while frames go to the warm standby endpoint", stats.on_standby, labels);
+    counter("failovers_total", "Switches from the primary endpoints to the standby", stats.failovers, labels);
+    counter("fallbacks_total", "Switches back to a reconnected primary", stats.fallbacks, labels);
+    gauge("last_failover_ms", "Time from the first frame no primary took to the first frame on the standby", stats.failover_ms, labels);
+}
+
+void MetricsExporter::addTcpInfo(const TcpInfoSample& info, const std::string& labels) {
+    if (!info.valid) {
+        return;
+    }
+    gauge("tcp_rtt_seconds", "Smoothed round trip time", info.rtt_us / 1e6, labels);
+    gauge("tcp_rtt_var_seconds", "Round trip time variance", info.rtt_var_us / 1e6, labels);
+    counter("tcp_retransmits_total", "Retransmitted segments", info.total_retrans, labels);
+    gauge("tcp_lost_segments", "Segments considered lost", info.lost, labels);
+    gauge("tcp_cwnd_segments", "Congestion window", info.cwnd, labels);
+    gauge("tcp_unacked_segments", "Segments in flight", info.unacked, labels);
+    gauge("tcp_unacked_bytes", "Bytes in flight", info.unacked_bytes, labels);
+    gauge("tcp_delivery_rate_bytes", "Delivery rate in bytes per second", static_cast<double>(info.delivery_rate), labels);
+}
+
+std::string MetricsExporter::endpointLabel(const std::string& address) {
+    std::string label = "endpoint=\"";
+    for (char c : address) {
+        if (c == '\\' || c == '"') {
+            label += '\\';
+        }
+        label += c;
+    }
+    return label + "\"";
+}
+
+void MetricsExporter::addTxLatency(const TxLatencyStats& latency, const std::string& labels) {
+    if (!latency.enabled) {
+        return;
+    }
+    header("tx_latency_seconds", "Time from sendData() through the kernel, from TX timestamps", "summary");
+    const std::pair<const char*, const LatencySummary*> stages[] = {
+        {"process", &latency.user}, {"stack", &latency.stack}, {"qdisc", &latency.qdisc},
+        {"total", &latency.total}, {"ack", &latency.ack}};
+    for (const auto& [stage, summary] : stages) {
+        std::string stage_labels = (labels.empty() ? "" : labels + ",") + "stage=\"" + stage + "\"";
+        value("tx_latency_seconds", summary->p50_us / 1e6, stage_labels + ",quantile=\"0.5\"");
+        value("tx_latency_seconds", summary->p99_us / 1e6, stage_labels + ",quantile=\"0.99\"");
+        value("tx_latency_seconds_count", static_cast<uint64_t>(summary->count), stage_labels);
+    }
+}
+
+int MetricsExporter::commit(void) {
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path);
+        if (!file) {
+            std::cerr << "Cannot write metrics to " << tmp_path << std::endl;
+            failed = true;
+            return -1;
+        }
+        file << out.str();
+    }
+    // rename is atomic, a scraper never sees a half written file
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Cannot replace " << path << std::endl;
+        failed = true;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include "structs.h"
+
+#include <chrono>
+#include <cstdint>
+#include <set>
+#include <sstream>
+#include <string>
+
+// Writes metrics in the Prometheus text format, e.g. for the node_exporter textfile collector
+class MetricsExporter {
+    std::string path;
+    std::chrono::steady_clock::time_point next_write;
+    int interval_ms;
+    bool failed; // stop retrying until the path changes
+    std::ostringstream out;
+    std::set<std::string> described; // HELP and TYPE are written once per metric, not per label set
+
+    void gauge(const char* name, const char* help, double value, const std::string& labels = "");
+    void counter(const char* name, const char* help, uint64_t value, const std::string& labels = "");
+    void header(const char* name, const char* help, const char* type);
+    void value(const char* name, double value, const std::string& labels);
+    void value(const char* name, uint64_t value, const std::string& labels);
+public:
+    MetricsExporter();
+    void setPath(const std::string& file_path);
+    bool isDue(void); // enabled and interval elapsed
+    void begin(void);
+    void addConnection(ConnectionState state, const SenderStats& stats, const std::string& labels = "");
+    void addTcpInfo(const TcpInfoSample& info, const std::string& labels = "");
+    void addTxLatency(const TxLatencyStats& latency, const std::string& labels = "");
+    std::string endpointLabel(const std::string& address); // endpoint="address", escaped
+    int commit(void); // atomically replaces the file, returns -1 on error
+};
+
+#endif // METRICS_EXPORTER_H
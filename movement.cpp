@@ -14,8 +14,13 @@ Movement::Movement() {
     mouse_sens = 0.5f; // mouse sensivity
     gamepad_axis_sens = 1.0f;
     gamepad_dead_zone = 0.1f;
-    r_rate_mod = 16.0f; // frame duration-dependent velocity correction
-    old_ticks = 0;
+    r_rate_mod = 0.0f; // frame duration-dependent velocity correction, nothing moves before the first tick
+    old_ticks_ns = 0;
+    fixed_step = false;
+    mouse_yaw = 0.0f;
+    mouse_pitch = 0.0f;
+    mouse_steps = 0;
+    pos_carry = {0.0f, 0.0f, 0.0f};
 }
 Movement::~Movement() {
 
@@ -41,8 +46,16 @@ void Movement::passKeyboardEvent(SDL_Event& event) {
     }
 }
 
-/* Pass how much cursor moved since the last frame */
+/* Pass how much cursor moved since the last frame. With fixed steps the delta is added up
+   until a frame runs steps, so frames without a step do not lose it. */
 void Movement::passMouseRelativePos(float x, float y) {
+    if (fixed_step) {
+        mouse_yaw += -x * mouse_sens;
+        mouse_pitch += -y * mouse_sens;
+        mov_mod.yaw = 0.0f; // the mouse replaces a turn left over from the gamepad, as it does per frame
+        mov_mod.pitch = 0.0f;
+        return;
+    }
     mov_mod.yaw = -x * mouse_sens;
     mov_mod.pitch = -y * mouse_sens;
 }
@@ -95,32 +108,65 @@ void Movement::passGamepadState(SDL_Gamepad& gamepad){
 
 }
 
-/* Ticks are used for frame time calculation and adjusting movement speed in every step */
-void Movement::updateTicks(Uint64 ticks) {
-    Uint64 frame_ticks = ticks - old_ticks;
-    r_rate_mod = static_cast<float>(frame_ticks);
-    old_ticks = ticks;
+/* Ticks are used for frame time calculation and adjusting movement speed in every step.
+   Nanoseconds, with millisecond ticks a 144 Hz frame alternated between 6, 7 and 8 ms */
+void Movement::updateTicks(Uint64 ticks_ns) {
+    if (old_ticks_ns == 0 || ticks_ns < old_ticks_ns) {
+        r_rate_mod = 0.0f; // first call only starts the clock
+    } else {
+        r_rate_mod = static_cast<float>(static_cast<double>(ticks_ns - old_ticks_ns) / 1e6);
+    }
+    old_ticks_ns = ticks_ns;
 }
 
-void Movement::updatePose(xrt_pose& pose) {
-    auto [yaw, pitch, roll] = quatToYXZ(pose.orientation);
+void Movement::setFixedStep(Uint64 step_ns) {
+    r_rate_mod = static_cast<float>(static_cast<double>(step_ns) / 1e6);
+    fixed_step = true;
+}
 
-    yaw += mov_mod.yaw * ang_vel * r_rate_mod;
-    pitch += mov_mod.pitch * ang_vel * r_rate_mod;
-    roll += mov_mod.roll * ang_vel * r_rate_mod;
-    pose.orientation = quatFromYXZ(yaw, pitch, roll);
+void Movement::beginSteps(int steps) {
+    mouse_steps = steps;
+}
+
+/* Rotation is applied as a quaternion delta, an Euler round trip every step piles up float error */
+void Movement::updatePose(xrt_pose& pose) {
+    float yaw = mov_mod.yaw * ang_vel * r_rate_mod;
+    float pitch = mov_mod.pitch * ang_vel * r_rate_mod;
+    float roll = mov_mod.roll * ang_vel * r_rate_mod;
+    if (mouse_steps > 0) {
+        // an equal share of what is left, the last step of the frame takes the rest
+        float yaw_share = mouse_yaw / mouse_steps;
+        float pitch_share = mouse_pitch / mouse_steps;
+        mouse_yaw -= yaw_share;
+        mouse_pitch -= pitch_share;
+        mouse_steps--;
+        yaw += yaw_share * ang_vel * mouse_frame_ms;
+        pitch += pitch_share * ang_vel * mouse_frame_ms;
+    }
+    if (yaw != 0.0f || pitch != 0.0f || roll != 0.0f) {
+        pose.orientation = quatRotateYXZ(pose.orientation, yaw, pitch, roll);
+    }
 
     xrt_vec3 delta_pos = { mov_mod.sidestep * lin_vel * r_rate_mod,
                            mov_mod.altitude * lin_vel * r_rate_mod,
                            mov_mod.walk * lin_vel * r_rate_mod };
-    delta_pos = quatMultVec(pose.orientation, delta_pos);
-    pose.position = pose.position + delta_pos;
+    delta_pos = quatMultVec(pose.orientation, delta_pos) + pos_carry;
+    // compensated sum: far from the origin a 1 ms step is below the float spacing, carry what rounding dropped
+    xrt_vec3 old_pos = pose.position;
+    pose.position = old_pos + delta_pos;
+    pos_carry = {delta_pos.x - (pose.position.x - old_pos.x), delta_pos.y - (pose.position.y - old_pos.y),
+                 delta_pos.z - (pose.position.z - old_pos.z)};
 }
 
 /* Calculates angular and linear velocity based on last two poses */
 void Movement::updateVelocity(const xrt_pose& pose, const xrt_pose& old_pose,
                                 xrt_vec3& lin_vel, xrt_vec3& ang_vel) {
-    float dt = r_rate_mod / 1000.0f; // r_rate_mod is number of ms ticks beetween frames
+    float dt = r_rate_mod / 1000.0f; // r_rate_mod is the time in ms between frames
+    if (dt <= 0.0f) {
+        lin_vel = {0.0f, 0.0f, 0.0f}; // no time has passed yet
+        ang_vel = {0.0f, 0.0f, 0.0f};
+        return;
+    }
     lin_vel.x = (pose.position.x - old_pose.position.x) / dt;
     lin_vel.y = (pose.position.y - old_pose.position.y) / dt;
     lin_vel.z = (pose.position.z - old_pose.position.z) / dt;
@@ -28,8 +28,12 @@ private:
 
     MovementModifier mov_mod{};
     float ang_vel, lin_vel, mouse_sens;
-    float r_rate_mod;
-    Uint64 old_ticks;
+    float r_rate_mod; // ms since the previous frame, scales all per-ms velocities
+    Uint64 old_ticks_ns;
+    bool fixed_step;
+    float mouse_yaw, mouse_pitch; // fixed step mode: mouse delta not turned into rotation yet
+    int mouse_steps; // updatePose() calls left to spread mouse_yaw and mouse_pitch over
+    xrt_vec3 pos_carry; // movement the float position could not take yet
     float gamepad_axis_sens;
     float gamepad_dead_zone;
 public:
@@ -39,9 +43,13 @@ public:
     void passKeyboardEvent(SDL_Event& event);
     void passMouseRelativePos(float x, float y);
     void passGamepadState(SDL_Gamepad& gamepad);
-    void updateTicks(Uint64 ticks);
+    void updateTicks(Uint64 ticks_ns); // SDL_GetTicksNS(), the same value for every Movement in a frame
+    void setFixedStep(Uint64 step_ns); // instead of updateTicks(), every updatePose() advances one simulation step
+    void beginSteps(int steps); // fixed step mode, before the updatePose() calls of a frame, 0 keeps gathering mouse input
     void updatePose(xrt_pose& pose);
     void updateVelocity(const xrt_pose& pose, const xrt_pose& old_pose, xrt_vec3& lin_vel, xrt_vec3& ang_vel);
 };
 
+static const float mouse_frame_ms = 1000.0f / 60.0f; // fixed step mode: a mouse delta turns as far as in one 60 Hz frame
+
 #endif // MOVEMENT_H
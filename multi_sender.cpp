@@ -0,0 +1,392 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "multi_sender.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include <sstream>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+static std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::vector<TransportAddress> parseEndpoints(const std::string& addresses) {
+    std::vector<TransportAddress> result;
+    std::istringstream in(addresses);
+    std::string entry;
+    while (std::getline(in, entry, ',')) {
+        entry = trim(entry);
+        if (entry.empty()) {
+            continue;
+        }
+        TransportAddress address;
+        if (parseTransportAddress(entry, MONADO_PORT, address) < 0) {
+            std::cerr << "Invalid endpoint " << entry << std::endl;
+            continue;
+        }
+        result.push_back(address);
+    }
+    return result;
+}
+
+MultiSender::MultiSender() {
+    resolver = std::make_shared<Resolver>();
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        std::cerr << "epoll_create1 failed, stalled writes are retried on the next frame" << std::endl;
+    }
+    connect_timeout_ms = 2000;
+    auto_reconnect = true;
+    protocol_version = defaultWireProtocol()->version;
+    send_mode = send_queue;
+    max_backlog_frames = 2;
+    backend = backend_socket;
+    uring_sqpoll = false;
+    tx_timestamps = false;
+    frame_stamps = false;
+    epoll_syscalls = 0;
+    primary_count = 0;
+    on_standby = false;
+    primary_missed = false;
+    failover_pending = false;
+    failovers = 0;
+    fallbacks = 0;
+    failover_ms = 0.0;
+}
+
+MultiSender::~MultiSender() {
+    closeAll();
+    if (epfd >= 0) {
+        close(epfd);
+    }
+}
+
+/* Keeps the options that were set before, only the list of connections is replaced */
+int MultiSender::openEndpoints(const std::string& addresses, const std::string& standby) {
+    auto parsed = parseEndpoints(addresses);
+    if (parsed.empty()) {
+        std::cerr << "No valid endpoint in " << addresses << std::endl;
+        return -1;
+    }
+    primary_count = parsed.size();
+    auto standby_parsed = parseEndpoints(standby);
+    if (standby_parsed.size() > 1) {
+        std::cerr << "Only one standby endpoint is supported, using " << formatTransportAddress(standby_parsed[0])
+                  << std::endl;
+    }
+    if (!standby_parsed.empty()) {
+        parsed.push_back(standby_parsed[0]);
+    }
+    on_standby = false;
+    primary_missed = false;
+    failover_pending = false;
+    // existing senders keep their counters, new ones need the options before they connect
+    while (endpoints.size() < parsed.size()) {
+        Endpoint endpoint;
+        endpoint.sender = std::make_unique<DataSender>();
+        endpoint.sender->setResolver(resolver);
+        endpoint.sender->setConnectTimeout(connect_timeout_ms);
+        endpoint.sender->setAutoReconnect(auto_reconnect);
+        endpoint.sender->setProtocol(protocol_version);
+        endpoint.sender->setBackend(backend, uring_sqpoll);
+        endpoint.sender->setTxTimestamps(tx_timestamps);
+        endpoint.sender->setFrameStamps(frame_stamps);
+        endpoints.push_back(std::move(endpoint));
+    }
+    endpoints.resize(parsed.size());
+    applySendMode();
+    int opened = 0;
+    for (size_t i = 0; i < parsed.size(); i++) {
+        Endpoint& endpoint = endpoints[i];
+        endpoint.address = formatTransportAddress(parsed[i]);
+        endpoint.tcp_info = TcpInfoSample{};
+        endpoint.standby = i >= primary_count;
+        if (endpoint.sender->openSocket(endpoint.address) == 0) {
+            opened++;
+        }
+    }
+    return opened > 0 ? 0 : -1;
+}
+
+void MultiSender::closeAll(void) {
+    for (auto& endpoint : endpoints) {
+        endpoint.sender->closeSocket(); // closing the fd also removes it from the epoll set
+    }
+}
+
+ConnectionState MultiSender::updateConnection(void) {
+    for (auto& endpoint : endpoints) {
+        endpoint.sender->updateConnection();
+    }
+    return getState();
+}
+
+ConnectionState MultiSender::getState(void) {
+    // connected beats connecting beats waiting, so the UI shows if anything is usable
+    static const int rank[] = {0, 2, 3, 1}; // indexed by ConnectionState
+    ConnectionState result = conn_disconnected;
+    for (auto& endpoint : endpoints) {
+        ConnectionState s = endpoint.sender->getState();
+        if (rank[s] > rank[result]) {
+            result = s;
+        }
+    }
+    return result;
+}
+
+int MultiSender::getRetryDelay(void) {
+    int delay = 0;
+    for (auto& endpoint : endpoints) {
+        int d = endpoint.sender->getRetryDelay();
+        if (d > 0 && (delay == 0 || d < delay)) {
+            delay = d;
+        }
+    }
+    return delay;
+}
+
+void MultiSender::setConnectTimeout(int timeout_ms) {
+    connect_timeout_ms = timeout_ms;
+    for (auto& endpoint : endpoints) {
+        endpoint.sender->setConnectTimeout(timeout_ms);
+    }
+}
+
+void MultiSender::setAutoReconnect(bool reconnect) {
+    auto_reconnect = reconnect;
+    for (auto& endpoint : endpoints) {
+        endpoint.sender->setAutoReconnect(reconnect);
+    }
+}
+
+int MultiSender::setProtocol(int version) {
+    if (!findWireProtocol(version)) {
+        return -1;
+    }
+    protocol_version = version;
+    for (auto& endpoint : endpoints) {
+        endpoint.sender->setProtocol(version);
+    }
+    return 0;
+}
+
+void MultiSender::setSendMode(SendMode mode, int max_backlog) {
+    send_mode = mode;
+    max_backlog_frames = max_backlog;
+    applySendMode();
+}
+
+/* Queue mode waits for the socket, with several endpoints that would let the slowest pace all of them,
+   and a primary that silently went away would hold back the standby until the send timeout */
+void MultiSender::applySendMode(void) {
+    SendMode mode = endpoints.size() > 1 ? send_latest : send_mode;
+    for (auto& endpoint : endpoints) {
+        endpoint.sender->setSendMode(mode, max_backlog_frames);
+    }
+}
+
+void MultiSender::setBackend(TransportBackend backend, bool sqpoll) {
+    this->backend = backend;
+    uring_sqpoll = sqpoll;
+    for (auto& endpoint : endpoints) {
+        endpoint.sender->setBackend(backend, sqpoll);
+    }
+}
+
+void MultiSender::setTxTimestamps(bool enable) {
+    tx_timestamps = enable;
+    for (auto& endpoint : endpoints) {
+        endpoint.sender->setTxTimestamps(enable);
+    }
+}
+
+void MultiSender::setFrameStamps(bool enable) {
+    frame_stamps = enable;
+    for (auto& endpoint : endpoints) {
+        endpoint.sender->setFrameStamps(enable);
+    }
+}
+
+size_t MultiSender::getCount(void) {
+    return endpoints.size();
+}
+
+/* A frame no primary took, because it failed or its backlog is full, goes to the standby in the same call */
+int MultiSender::sendData(const r_remote_data& data, uint64_t origin_ns) {
+    int handed = 0;
+    for (size_t i = 0; i < primary_count && i < endpoints.size(); i++) {
+        DataSender& sender = *endpoints[i].sender;
+        // latest wins, a frame held back stays queued on the primary and goes out if it recovers
+        if (sender.isConnected() && sender.sendData(data, origin_ns) == 0 && !sender.hasPending()) {
+            handed++;
+        }
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (handed > 0) {
+        primary_missed = false;
+        if (on_standby) {
+            on_standby = false;
+            fallbacks++;
+            std::cout << "Primary endpoint is back, leaving the standby" << std::endl;
+        }
+        return handed;
+    }
+    if (!primary_missed) {
+        primary_missed = true;
+        first_missed = now;
+    }
+    if (primary_count >= endpoints.size() || !endpoints.back().sender->isConnected()) {
+        return handed;
+    }
+    if (!on_standby) {
+        on_standby = true;
+        failover_pending = true;
+        failovers++;
+    }
+    if (endpoints.back().sender->sendData(data, origin_ns) == 0) {
+        handed++;
+        if (failover_pending) {
+            failover_pending = false;
+            failover_ms = std::chrono::duration<double, std::milli>(now - first_missed).count();
+            std::cout << "Failed over to " << endpoints.back().address << ", " << failover_ms
+                      << " ms after the first frame no primary took" << std::endl;
+        }
+    }
+    return handed;
+}
+
+size_t MultiSender::activeIndex(void) {
+    return on_standby ? endpoints.size() - 1 : 0;
+}
+
+/* Sleeps in epoll_wait instead of the sender thread's sleep, so a connection whose socket
+   was full can finish its frame as soon as the kernel makes room, not one period later */
+void MultiSender::waitWritable(std::chrono::steady_clock::time_point deadline) {
+    if (epfd < 0) {
+        return;
+    }
+    while (true) {
+        bool waiting = false;
+        for (size_t i = 0; i < endpoints.size(); i++) {
+            uint32_t events = 0;
+            int fd = endpoints[i].sender->getPollFd(events);
+            if (fd < 0) {
+                continue;
+            }
+            // one-shot, a socket that stays writable while held back by the backlog limit must not spin
+            epoll_event ev {};
+            ev.events = events | EPOLLONESHOT;
+            ev.data.u32 = static_cast<uint32_t>(i);
+            epoll_syscalls++;
+            if (epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+                epoll_syscalls++;
+                if (errno != ENOENT || epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                    continue;
+                }
+            }
+            waiting = true;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (!waiting || now >= deadline) {
+            return;
+        }
+        // ms resolution of epoll_wait, the caller sleeps the rest precisely
+        int timeout = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count());
+        if (timeout == 0) {
+            return;
+        }
+        epoll_event ready[16];
+        epoll_syscalls++;
+        int n = epoll_wait(epfd, ready, 16, timeout);
+        if (n <= 0) {
+            return; // timeout, or EINTR: the next tick retries anyway
+        }
+        for (int i = 0; i < n; i++) {
+            uint32_t index = ready[i].data.u32;
+            if (index < endpoints.size()) {
+                endpoints[index].sender->flushPending();
+            }
+        }
+    }
+}
+
+void MultiSender::collectTimestamps(void) {
+    for (auto& endpoint : endpoints) {
+        endpoint.sender->collectTimestamps();
+    }
+}
+
+void MultiSender::sampleTcpInfo(void) {
+    for (auto& endpoint : endpoints) {
+        endpoint.sender->sampleTcpInfo(endpoint.tcp_info);
+    }
+}
+
+SenderStats MultiSender::getStats(SenderStats* active) {
+    SenderStats total{};
+    for (size_t i = 0; i < endpoints.size(); i++) {
+        SenderStats s = endpoints[i].sender->getStats();
+        if (active && i == activeIndex()) {
+            *active = s;
+        }
+        total.sent += s.sent;
+        total.dropped += s.dropped;
+        total.coalesced += s.coalesced;
+        total.partial_writes += s.partial_writes;
+        total.syscalls += s.syscalls;
+        total.backlog_bytes = std::max(total.backlog_bytes, s.backlog_bytes);
+        if (i == 0) {
+            total.backend = s.backend;
+        }
+    }
+    total.syscalls += epoll_syscalls;
+    total.on_standby = on_standby;
+    total.failovers = failovers;
+    total.fallbacks = fallbacks;
+    total.failover_ms = failover_ms;
+    return total;
+}
+
+TxLatencyStats MultiSender::getTxLatency(void) {
+    if (endpoints.empty()) {
+        return TxLatencyStats{};
+    }
+    return endpoints[activeIndex()].sender->getTxLatency();
+}
+
+TcpInfoSample MultiSender::getTcpInfo(void) {
+    if (endpoints.empty()) {
+        return TcpInfoSample{};
+    }
+    return endpoints[activeIndex()].tcp_info;
+}
+
+std::vector<EndpointStatus> MultiSender::getEndpointStatus(bool with_latency) {
+    std::vector<EndpointStatus> result;
+    result.reserve(endpoints.size());
+    for (auto& endpoint : endpoints) {
+        EndpointStatus status;
+        status.address = endpoint.address;
+        status.state = endpoint.sender->getState();
+        status.retry_in_ms = endpoint.sender->getRetryDelay();
+        status.stats = endpoint.sender->getStats();
+        status.tcp_info = endpoint.tcp_info;
+        status.standby = endpoint.standby;
+        if (with_latency) {
+            status.tx_latency = endpoint.sender->getTxLatency();
+        }
+        result.push_back(status);
+    }
+    return result;
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef MULTI_SENDER_H
+#define MULTI_SENDER_H
+
+#include "structs.h"
+#include "data_sender.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Sends one pose stream to several monado-service instances, a slow one never holds back the others
+class MultiSender {
+    struct Endpoint {
+        std::string address;
+        std::unique_ptr<DataSender> sender;
+        TcpInfoSample tcp_info{};
+        bool standby = false;
+    };
+    std::vector<Endpoint> endpoints; // primaries, then the standby if there is one
+    size_t primary_count;
+    std::shared_ptr<Resolver> resolver; // one lookup cache for all endpoints
+    int epfd;
+    int connect_timeout_ms;
+    bool auto_reconnect;
+    int protocol_version;
+    SendMode send_mode;
+    int max_backlog_frames;
+    TransportBackend backend;
+    bool uring_sqpoll;
+    bool tx_timestamps;
+    bool frame_stamps;
+    uint64_t epoll_syscalls;
+
+    // warm standby, gets frames only while no primary takes them
+    bool on_standby;
+    bool primary_missed; // no primary took the last frame
+    std::chrono::steady_clock::time_point first_missed; // the first frame of that run
+    bool failover_pending; // switched, waiting for the first frame on the standby to time the gap
+    uint64_t failovers;
+    uint64_t fallbacks;
+    double failover_ms; // last time from the first frame no primary took to the first frame on the standby
+
+    void applySendMode(void);
+    size_t activeIndex(void);
+public:
+    MultiSender();
+    ~MultiSender();
+    // comma separated, see parseEndpoints(), -1 if none is valid; standby is kept connected but idle
+    int openEndpoints(const std::string& addresses, const std::string& standby = "");
+    void closeAll(void);
+    ConnectionState updateConnection(void);
+    ConnectionState getState(void); // the most advanced state of all endpoints
+    int getRetryDelay(void); // ms until the nearest reconnection attempt
+    void setConnectTimeout(int timeout_ms);
+    void setAutoReconnect(bool reconnect);
+    void setSendMode(SendMode mode, int max_backlog);
+    int setProtocol(int version);
+    void setBackend(TransportBackend backend, bool sqpoll);
+    void setTxTimestamps(bool enable);
+    void setFrameStamps(bool enable);
+    size_t getCount(void);
+    int sendData(const r_remote_data& data, uint64_t origin_ns = 0); // number of endpoints the frame was handed to
+    void waitWritable(std::chrono::steady_clock::time_point deadline); // finishes stalled writes until deadline
+    void collectTimestamps(void);
+    void sampleTcpInfo(void);
+    SenderStats getStats(SenderStats* active = nullptr); // summed over all endpoints, active: the getTcpInfo() endpoint alone
+    TxLatencyStats getTxLatency(void); // of the first primary, or of the standby while failed over
+    TcpInfoSample getTcpInfo(void); // same endpoint as getTxLatency()
+    std::vector<EndpointStatus> getEndpointStatus(bool with_latency);
+};
+
+// splits "ip[:port], unix:/path, shm:/name" into trimmed entries, port defaults to MONADO_PORT
+std::vector<TransportAddress> parseEndpoints(const std::string& addresses);
+
+#endif // MULTI_SENDER_H
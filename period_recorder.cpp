@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "period_recorder.h"
+#include "tx_timestamps.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+PeriodRecorder::PeriodRecorder() {
+    last_ns = 0;
+}
+
+void PeriodRecorder::reserve(size_t count) {
+    periods.reserve(count);
+}
+
+void PeriodRecorder::reset(void) {
+    periods.clear();
+    last_ns = 0;
+}
+
+void PeriodRecorder::mark(void) {
+    uint64_t now = monotonicNs();
+    if (last_ns != 0) {
+        periods.push_back(now - last_ns);
+    }
+    last_ns = now;
+}
+
+size_t PeriodRecorder::getCount(void) const {
+    return periods.size();
+}
+
+uint64_t PeriodRecorder::getMedian(void) const {
+    if (periods.empty()) {
+        return 0;
+    }
+    std::vector<uint64_t> sorted = periods;
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    return sorted[sorted.size() / 2];
+}
+
+PeriodSummary PeriodRecorder::getSummary(uint64_t nominal_ns) const {
+    PeriodSummary s;
+    if (periods.empty()) {
+        return s;
+    }
+    if (nominal_ns == 0) {
+        nominal_ns = getMedian();
+    }
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    std::vector<uint64_t> deviations;
+    deviations.reserve(periods.size());
+    for (uint64_t period : periods) {
+        sum += period;
+        sum_sq += static_cast<double>(period) * period;
+        deviations.push_back(period > nominal_ns ? period - nominal_ns : nominal_ns - period);
+    }
+    std::sort(deviations.begin(), deviations.end());
+    // nearest rank, exact on the raw values
+    auto rank = [&](double percentile) {
+        size_t index = static_cast<size_t>(std::ceil(percentile / 100.0 * deviations.size()));
+        return deviations[std::clamp<size_t>(index, 1, deviations.size()) - 1] / 1000.0;
+    };
+    double n = static_cast<double>(periods.size());
+    double mean = sum / n;
+    s.count = periods.size();
+    s.nominal_us = nominal_ns / 1000.0;
+    s.mean_us = mean / 1000.0;
+    s.stddev_us = std::sqrt(std::max(0.0, sum_sq / n - mean * mean)) / 1000.0;
+    s.min_us = *std::min_element(periods.begin(), periods.end()) / 1000.0;
+    s.max_us = *std::max_element(periods.begin(), periods.end()) / 1000.0;
+    s.dev_p50_us = rank(50.0);
+    s.dev_p99_us = rank(99.0);
+    s.dev_p999_us = rank(99.9);
+    s.dev_max_us = deviations.back() / 1000.0;
+    return s;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> PeriodRecorder::getHistogram(uint64_t bucket_ns) const {
+    std::map<uint64_t, uint64_t> buckets;
+    bucket_ns = std::max<uint64_t>(bucket_ns, 1);
+    for (uint64_t period : periods) {
+        buckets[period / bucket_ns * bucket_ns]++;
+    }
+    return {buckets.begin(), buckets.end()};
+}
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef PERIOD_RECORDER_H
+#define PERIOD_RECORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+struct PeriodSummary {
+    uint64_t count = 0;
+    double nominal_us = 0.0; // the period deviations are measured against
+    double mean_us = 0.0;
+    double stddev_us = 0.0;
+    double min_us = 0.0;
+    double max_us = 0.0;
+    double dev_p50_us = 0.0; // |period - nominal|
+    double dev_p99_us = 0.0;
+    double dev_p999_us = 0.0;
+    double dev_max_us = 0.0;
+};
+
+// Periods between successive mark() calls on CLOCK_MONOTONIC, kept raw so the nominal period can be chosen later
+class PeriodRecorder {
+    std::vector<uint64_t> periods; // ns
+    uint64_t last_ns;
+public:
+    PeriodRecorder();
+    void reserve(size_t count); // mark() does not allocate until that many periods
+    void reset(void);
+    void mark(void);
+    size_t getCount(void) const;
+    uint64_t getMedian(void) const; // ns, 0 without periods
+    PeriodSummary getSummary(uint64_t nominal_ns = 0) const; // 0: deviations from the median period
+    std::vector<std::pair<uint64_t, uint64_t>> getHistogram(uint64_t bucket_ns) const; // (bucket start ns, count)
+};
+
+#endif // PERIOD_RECORDER_H
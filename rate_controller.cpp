@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "rate_controller.h"
+#include "wire_protocol.h"
+
+#include <algorithm>
+#include <limits>
+
+RateControl rateControlFromConfig(const Config& config) {
+    RateControl control;
+    control.min_hz = std::max(config.adaptive_min_rate, 1);
+    control.max_hz = std::max(config.adaptive_max_rate, control.min_hz);
+    control.rtt_margin_ms = std::max(config.adaptive_rtt_margin_ms, 0.0f);
+    const WireProtocol* protocol = findWireProtocol(config.protocol_version);
+    if (protocol) {
+        control.frame_bytes = protocol->frame_size;
+    }
+    return control;
+}
+
+RateController::RateController() {
+    rate = control.max_hz;
+    max_backlog = 0;
+    last_dropped = 0;
+    holdoff = false;
+    min_rtt_us = std::numeric_limits<uint32_t>::max();
+    prev_min_rtt_us = std::numeric_limits<uint32_t>::max();
+    decreases = 0;
+    history.fill(0.0f);
+    history_pos = 0;
+    history_count = 0;
+}
+
+void RateController::setControl(const RateControl& rate_control) {
+    control = rate_control;
+    rate = std::clamp(rate, static_cast<double>(control.min_hz), static_cast<double>(control.max_hz));
+}
+
+void RateController::reset(int rate_hz, uint64_t dropped) {
+    rate = std::clamp(rate_hz, control.min_hz, control.max_hz);
+    next_update = clock::now() + std::chrono::milliseconds(rate_interval_ms);
+    max_backlog = 0;
+    last_dropped = dropped;
+    holdoff = false;
+    min_rtt_us = std::numeric_limits<uint32_t>::max(); // the new path may be a different one
+    prev_min_rtt_us = std::numeric_limits<uint32_t>::max();
+}
+
+/* The backlog counts unacknowledged data too, about rate * RTT of it is in flight on a healthy link */
+bool RateController::congested(const SenderStats& stats, const TcpInfoSample& info) {
+    if (stats.dropped > last_dropped) {
+        return true; // latest-wins mode already had to skip frames
+    }
+    double rtt_s = info.valid ? info.rtt_us / 1e6 : 0.0;
+    double in_flight = (rate * rtt_s + 2.0) * control.frame_bytes;
+    if (max_backlog > in_flight) {
+        return true;
+    }
+    if (info.valid && min_rtt_us != std::numeric_limits<uint32_t>::max()
+        && info.rtt_us > std::min(min_rtt_us, prev_min_rtt_us) + control.rtt_margin_ms * 1000.0f) {
+        return true;
+    }
+    return false;
+}
+
+/* Windowed minimum, so a route change to a slower path becomes the new baseline within 20 s */
+void RateController::updateBaseline(const TcpInfoSample& info, clock::time_point now) {
+    if (now >= rtt_window_end) {
+        prev_min_rtt_us = min_rtt_us;
+        min_rtt_us = std::numeric_limits<uint32_t>::max();
+        rtt_window_end = now + std::chrono::seconds(10);
+    }
+    if (info.valid && info.rtt_us > 0) {
+        min_rtt_us = std::min(min_rtt_us, info.rtt_us);
+    }
+}
+
+int RateController::update(clock::time_point now, const SenderStats& stats, const TcpInfoSample& info) {
+    max_backlog = std::max(max_backlog, stats.backlog_bytes);
+    if (now < next_update) {
+        return getRate();
+    }
+    next_update = now + std::chrono::milliseconds(rate_interval_ms);
+    bool cut = !holdoff && congested(stats, info);
+    updateBaseline(info, now);
+    if (cut) {
+        rate *= rate_decrease_factor;
+        decreases++;
+    } else {
+        // the whole range is climbed in about 10 s
+        rate += std::max(1.0, (control.max_hz - control.min_hz) / 100.0);
+    }
+    rate = std::clamp(rate, static_cast<double>(control.min_hz), static_cast<double>(control.max_hz));
+    holdoff = cut;
+    max_backlog = 0;
+    last_dropped = stats.dropped;
+    history[history_pos] = static_cast<float>(rate);
+    history_pos = (history_pos + 1) % history.size();
+    history_count = std::min(history_count + 1, history.size());
+    return getRate();
+}
+
+int RateController::getRate(void) {
+    return static_cast<int>(rate + 0.5);
+}
+
+uint64_t RateController::getDecreases(void) {
+    return decreases;
+}
+
+std::vector<float> RateController::getHistory(void) {
+    std::vector<float> result;
+    result.reserve(history_count);
+    size_t start = (history_pos + history.size() - history_count) % history.size();
+    for (size_t i = 0; i < history_count; i++) {
+        result.push_back(history[(start + i) % history.size()]);
+    }
+    return result;
+}
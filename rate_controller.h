@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef RATE_CONTROLLER_H
+#define RATE_CONTROLLER_H
+
+#include "structs.h"
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+// bounds of the adaptive send rate
+struct RateControl {
+    int min_hz = 30;
+    int max_hz = 1000;
+    float rtt_margin_ms = 10.0f; // smoothed RTT this far above the baseline counts as congestion
+    size_t frame_bytes = sizeof(r_remote_data); // on the wire, depends on the protocol version
+};
+
+RateControl rateControlFromConfig(const Config& config);
+
+/* AIMD on the pose send rate: a step up every interval without congestion, a cut by a factor when the
+   socket backlog grows beyond what the RTT explains, frames are dropped or the RTT rises */
+class RateController {
+    using clock = std::chrono::steady_clock;
+    RateControl control;
+    double rate; // Hz
+    clock::time_point next_update;
+    int max_backlog; // largest backlog seen in the current interval
+    uint64_t last_dropped;
+    bool holdoff; // skip the interval right after a cut, its signals still show the old rate
+    uint32_t min_rtt_us; // baseline, minimum of the current and the previous window
+    uint32_t prev_min_rtt_us;
+    clock::time_point rtt_window_end;
+    uint64_t decreases;
+    std::array<float, 120> history; // one entry per interval, oldest is overwritten
+    size_t history_pos;
+    size_t history_count;
+
+    bool congested(const SenderStats& stats, const TcpInfoSample& info);
+    void updateBaseline(const TcpInfoSample& info, clock::time_point now);
+public:
+    RateController();
+    void setControl(const RateControl& rate_control);
+    void reset(int rate_hz, uint64_t dropped); // e.g. after reconnecting, the history is kept
+    int update(clock::time_point now, const SenderStats& stats, const TcpInfoSample& info); // rate for the next tick
+    int getRate(void);
+    uint64_t getDecreases(void);
+    std::vector<float> getHistory(void); // Hz, oldest first
+};
+
+static const int rate_interval_ms = 100;
+static const double rate_decrease_factor = 0.7;
+
+#endif // RATE_CONTROLLER_H
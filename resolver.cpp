@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "resolver.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <thread>
+
+static const auto positive_ttl = std::chrono::seconds(60); // getaddrinfo does not report the DNS TTL
+static const auto negative_ttl = std::chrono::seconds(5);
+
+bool parseNumericHost(const std::string& host, int port, ResolvedAddress& result) {
+    result = ResolvedAddress{};
+    sockaddr_in* in = reinterpret_cast<sockaddr_in*>(&result.addr);
+    if (inet_pton(AF_INET, host.c_str(), &in->sin_addr) == 1) {
+        in->sin_family = AF_INET;
+        in->sin_port = htons(port);
+        result.len = sizeof(sockaddr_in);
+        return true;
+    }
+    sockaddr_in6* in6 = reinterpret_cast<sockaddr_in6*>(&result.addr);
+    if (inet_pton(AF_INET6, host.c_str(), &in6->sin6_addr) == 1) {
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(port);
+        result.len = sizeof(sockaddr_in6);
+        return true;
+    }
+    return false;
+}
+
+std::string formatSockaddr(const ResolvedAddress& address) {
+    char buf[INET6_ADDRSTRLEN] = "";
+    if (address.addr.ss_family == AF_INET6) {
+        const sockaddr_in6* in6 = reinterpret_cast<const sockaddr_in6*>(&address.addr);
+        inet_ntop(AF_INET6, &in6->sin6_addr, buf, sizeof(buf));
+        return std::string("[") + buf + "]:" + std::to_string(ntohs(in6->sin6_port));
+    }
+    const sockaddr_in* in = reinterpret_cast<const sockaddr_in*>(&address.addr);
+    inet_ntop(AF_INET, &in->sin_addr, buf, sizeof(buf));
+    return std::string(buf) + ":" + std::to_string(ntohs(in->sin_port));
+}
+
+struct Resolver::Shared {
+    struct Entry {
+        enum { pending, done, failed } state = pending;
+        bool refreshing = false;
+        std::vector<ResolvedAddress> addresses;
+        std::chrono::steady_clock::time_point expires;
+    };
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::pair<std::string, int>> requests;
+    std::map<std::pair<std::string, int>, Entry> cache;
+    bool stop = false;
+};
+
+/* RFC 8305: alternate address families, starting with the family getaddrinfo preferred */
+static std::vector<ResolvedAddress> interleaveFamilies(const std::vector<ResolvedAddress>& sorted) {
+    if (sorted.empty()) {
+        return sorted;
+    }
+    int first_family = sorted.front().addr.ss_family;
+    std::vector<ResolvedAddress> first, second, result;
+    for (const auto& address : sorted) {
+        (address.addr.ss_family == first_family ? first : second).push_back(address);
+    }
+    for (size_t i = 0; i < first.size() || i < second.size(); i++) {
+        if (i < first.size()) {
+            result.push_back(first[i]);
+        }
+        if (i < second.size()) {
+            result.push_back(second[i]);
+        }
+    }
+    return result;
+}
+
+void Resolver::worker(std::shared_ptr<Shared> shared) {
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    while (true) {
+        shared->wake.wait(lock, [&] { return shared->stop || !shared->requests.empty(); });
+        if (shared->stop) {
+            return;
+        }
+        auto key = shared->requests.front();
+        shared->requests.pop_front();
+        lock.unlock();
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_ADDRCONFIG; // no IPv6 candidates on a host without IPv6
+        addrinfo* info = nullptr;
+        int err = getaddrinfo(key.first.c_str(), std::to_string(key.second).c_str(), &hints, &info);
+        std::vector<ResolvedAddress> addresses;
+        for (addrinfo* ai = info; err == 0 && ai; ai = ai->ai_next) {
+            if ((ai->ai_family == AF_INET || ai->ai_family == AF_INET6) && ai->ai_addrlen <= sizeof(sockaddr_storage)) {
+                ResolvedAddress address{};
+                memcpy(&address.addr, ai->ai_addr, ai->ai_addrlen);
+                address.len = ai->ai_addrlen;
+                addresses.push_back(address);
+            }
+        }
+        if (info) {
+            freeaddrinfo(info);
+        }
+        if (err != 0) {
+            std::cerr << "Cannot resolve " << key.first << ": " << gai_strerror(err) << std::endl;
+        }
+
+        lock.lock();
+        auto& entry = shared->cache[key];
+        entry.refreshing = false;
+        if (!addresses.empty()) {
+            entry.state = Shared::Entry::done;
+            entry.addresses = interleaveFamilies(addresses);
+            entry.expires = std::chrono::steady_clock::now() + positive_ttl;
+        } else if (entry.state != Shared::Entry::done) {
+            entry.state = Shared::Entry::failed;
+            entry.expires = std::chrono::steady_clock::now() + negative_ttl;
+        } else {
+            entry.expires = std::chrono::steady_clock::now() + negative_ttl; // keep the old addresses a bit longer
+        }
+    }
+}
+
+Resolver::Resolver() : shared(std::make_shared<Shared>()) {
+    std::thread(worker, shared).detach();
+}
+
+Resolver::~Resolver() {
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    shared->stop = true;
+    shared->wake.notify_all();
+}
+
+int Resolver::lookup(const std::string& host, int port, std::vector<ResolvedAddress>& result) {
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    auto key = std::make_pair(host, port);
+    auto it = shared->cache.find(key);
+    bool expired = it != shared->cache.end() && it->second.state != Shared::Entry::pending
+                   && std::chrono::steady_clock::now() >= it->second.expires;
+    if (it == shared->cache.end() || (expired && !it->second.refreshing)) {
+        auto& entry = shared->cache[key];
+        if (it == shared->cache.end() || entry.state == Shared::Entry::failed) {
+            entry.state = Shared::Entry::pending; // a failed name is looked up again, not reported as failed
+        }
+        entry.refreshing = true;
+        shared->requests.push_back(key);
+        shared->wake.notify_one();
+        it = shared->cache.find(key);
+    }
+    switch (it->second.state) {
+    case Shared::Entry::done:
+        result = it->second.addresses; // stale addresses are still the best guess during a refresh
+        return 1;
+    case Shared::Entry::failed:
+        return -1;
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <vector>
+
+struct ResolvedAddress {
+    sockaddr_storage addr;
+    socklen_t len;
+};
+
+// "1.2.3.4" or "::1" without any lookup, false if host is a name
+bool parseNumericHost(const std::string& host, int port, ResolvedAddress& result);
+std::string formatSockaddr(const ResolvedAddress& address);
+
+// getaddrinfo on a worker thread with a cache, lookup() never blocks the caller
+class Resolver {
+    struct Shared;
+    std::shared_ptr<Shared> shared; // the worker keeps it alive, a stuck getaddrinfo cannot block the destructor
+    static void worker(std::shared_ptr<Shared> shared);
+
+public:
+    Resolver();
+    ~Resolver();
+    /* 1: addresses ready (possibly stale while a refresh runs), 0: lookup in progress, -1: failed.
+       Addresses are ordered for happy eyeballs, families interleaved starting with the preferred one. */
+    int lookup(const std::string& host, int port, std::vector<ResolvedAddress>& result);
+};
+
+#endif // RESOLVER_H
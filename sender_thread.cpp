@@ -0,0 +1,373 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "sender_thread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#if defined(__linux__)
+#include <sys/prctl.h>
+#endif
+
+SenderThread::SenderThread() {
+    multiSender = std::make_unique<MultiSender>();
+    running = false;
+    send_rate = 250;
+    has_data = false;
+    latest_origin = 0;
+    connect_requested = false;
+    connect_pending = false;
+    connect_timeout_ms = 2000;
+    auto_reconnect = true;
+    conn_state = conn_disconnected;
+    retry_in_ms = 0;
+    protocol_version = defaultWireProtocol()->version;
+    send_mode = send_queue;
+    max_backlog_frames = 2;
+    backend = backend_socket;
+    uring_sqpoll = false;
+    tx_timestamps = false;
+    frame_stamps = false;
+    tcp_info_interval_ms = 250;
+    send_on_change = false;
+    adaptive_rate = false;
+    send_recorder = nullptr;
+}
+
+SenderThread::~SenderThread() {
+    stop();
+}
+
+void SenderThread::start(int rate_hz) {
+    if (running) {
+        return;
+    }
+    setRate(rate_hz);
+    running = true;
+    thread = std::thread(&SenderThread::run, this);
+}
+
+void SenderThread::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    multiSender->closeAll();
+    conn_state = conn_disconnected;
+}
+
+void SenderThread::setRate(int rate_hz) {
+    send_rate = std::clamp(rate_hz, min_send_rate, max_send_rate);
+}
+
+/* Called by the render loop, the sender thread always picks up the newest frame */
+void SenderThread::publish(const r_remote_data& data, uint64_t origin_ns) {
+    std::lock_guard<std::mutex> lock(data_mutex);
+    latest = data;
+    has_data = true;
+    if (latest_origin == 0) {
+        latest_origin = origin_ns; // newer frames carry the effect of the older input too
+    }
+}
+
+void SenderThread::requestConnect(const std::string& ip, const std::string& standby) {
+    std::lock_guard<std::mutex> lock(conn_mutex);
+    server_ip = ip;
+    standby_ip = standby;
+    connect_requested = true;
+    connect_pending = true;
+}
+
+void SenderThread::requestDisconnect() {
+    std::lock_guard<std::mutex> lock(conn_mutex);
+    connect_requested = false;
+    connect_pending = false;
+}
+
+void SenderThread::setConnectOptions(int timeout_ms, bool reconnect) {
+    connect_timeout_ms = timeout_ms;
+    auto_reconnect = reconnect;
+}
+
+int SenderThread::setProtocol(int version) {
+    if (!findWireProtocol(version)) {
+        return -1;
+    }
+    protocol_version = version;
+    return 0;
+}
+
+void SenderThread::setSendMode(SendMode mode, int max_backlog) {
+    send_mode = mode;
+    max_backlog_frames = max_backlog;
+}
+
+void SenderThread::setBackend(TransportBackend backend, bool sqpoll) {
+    this->backend = backend;
+    uring_sqpoll = sqpoll;
+}
+
+void SenderThread::setTxTimestamps(bool enable) {
+    tx_timestamps = enable;
+}
+
+void SenderThread::setFrameStamps(bool enable) {
+    frame_stamps = enable;
+}
+
+void SenderThread::setTcpInfoInterval(int interval_ms) {
+    tcp_info_interval_ms = std::max(interval_ms, 10);
+}
+
+void SenderThread::setSendOnChange(bool enable, const DeadBand& band) {
+    std::lock_guard<std::mutex> lock(filter_mutex);
+    send_on_change = enable;
+    dead_band = band;
+    dead_band.keepalive_ms = std::max(band.keepalive_ms, 1);
+}
+
+void SenderThread::setImpairment(const ImpairmentProfile& profile) {
+    std::lock_guard<std::mutex> lock(impair_mutex);
+    impair_profile = profile;
+}
+
+void SenderThread::setAdaptiveRate(bool enable, const RateControl& control) {
+    std::lock_guard<std::mutex> lock(rate_mutex);
+    adaptive_rate = enable;
+    rate_control = control;
+}
+
+void SenderThread::setSendRecorder(PeriodRecorder* recorder) {
+    send_recorder = recorder;
+}
+
+bool SenderThread::isConnectRequested() {
+    return connect_requested;
+}
+
+bool SenderThread::isConnected() {
+    return conn_state == conn_connected;
+}
+
+ConnectionState SenderThread::getState() {
+    return conn_state;
+}
+
+int SenderThread::getRetryDelay() {
+    return retry_in_ms;
+}
+
+SenderStats SenderThread::getStats() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return stats;
+}
+
+TxLatencyStats SenderThread::getTxLatency() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return tx_latency;
+}
+
+TcpInfoSample SenderThread::getTcpInfo() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return tcp_info;
+}
+
+std::vector<EndpointStatus> SenderThread::getEndpoints() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return endpoint_status;
+}
+
+std::vector<float> SenderThread::getRateHistory() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return rate_history;
+}
+
+/* Socket is opened and closed only here, so sendData never races with the UI thread */
+void SenderThread::updateConnection() {
+    multiSender->setConnectTimeout(connect_timeout_ms);
+    multiSender->setAutoReconnect(auto_reconnect);
+    multiSender->setProtocol(protocol_version);
+    multiSender->setSendMode(send_mode, max_backlog_frames);
+    multiSender->setBackend(backend, uring_sqpoll);
+    multiSender->setTxTimestamps(tx_timestamps);
+    multiSender->setFrameStamps(frame_stamps);
+    std::lock_guard<std::mutex> lock(conn_mutex);
+    if (connect_pending) {
+        connect_pending = false;
+        if (multiSender->openEndpoints(server_ip, standby_ip) < 0) {
+            connect_requested = false; // let the user click Connect again
+        }
+    }
+    if (connect_requested) {
+        if (multiSender->updateConnection() == conn_disconnected) {
+            connect_requested = false; // gave up, reconnecting is disabled
+        }
+    } else if (multiSender->getState() != conn_disconnected) {
+        multiSender->closeAll();
+    }
+    conn_state = multiSender->getState();
+    retry_in_ms = multiSender->getRetryDelay();
+}
+
+/* Hands frames whose emulated network delay is over to the socket, they are lost while disconnected */
+void SenderThread::releaseImpaired(std::chrono::steady_clock::time_point now) {
+    r_remote_data frame;
+    uint64_t origin_ns;
+    while (impairment.isEnabled() ? impairment.pop(now, frame, origin_ns) : impairment.popAny(frame, origin_ns)) {
+        if (conn_state == conn_connected) {
+            multiSender->sendData(frame, origin_ns);
+            if (PeriodRecorder* recorder = send_recorder) {
+                recorder->mark();
+            }
+        }
+    }
+}
+
+void SenderThread::run() {
+#if defined(__linux__)
+    prctl(PR_SET_TIMERSLACK, 1UL); // default 50 us slack is too coarse for 1 kHz
+#endif
+    using clock = std::chrono::steady_clock;
+    auto next = clock::now();
+    auto next_latency_update = next;
+    auto next_tcp_info = next;
+    r_remote_data frame{};
+    ConnectionState prev_state = conn_disconnected;
+    bool was_adaptive = false;
+    uint64_t switches = 0;
+    int rate_hz = send_rate;
+
+    while (running) {
+        updateConnection();
+        bool connected_now = conn_state == conn_connected && prev_state != conn_connected;
+        if (connected_now) {
+            changeFilter.reset(); // Monado needs a full frame right after (re)connecting
+        }
+        prev_state = conn_state;
+        bool adaptive;
+        {
+            std::lock_guard<std::mutex> lock(rate_mutex);
+            adaptive = adaptive_rate;
+            rateController.setControl(rate_control);
+        }
+        bool filter_enabled;
+        {
+            std::lock_guard<std::mutex> lock(filter_mutex);
+            filter_enabled = send_on_change;
+            changeFilter.setDeadBand(dead_band);
+        }
+        {
+            std::lock_guard<std::mutex> lock(impair_mutex);
+            impairment.setProfile(impair_profile);
+        }
+        impairment.setFrameSize(findWireProtocol(protocol_version)->frame_size);
+        releaseImpaired(clock::now());
+
+        bool send = false;
+        uint64_t origin_ns = 0;
+        {
+            std::lock_guard<std::mutex> lock(data_mutex);
+            if (has_data) {
+                frame = latest;
+                send = true;
+                origin_ns = latest_origin;
+                latest_origin = 0;
+            }
+        }
+        if (send && conn_state == conn_connected) {
+            if (!filter_enabled || changeFilter.shouldSend(frame, clock::now())) {
+                if (impairment.isEnabled()) {
+                    impairment.push(frame, clock::now(), origin_ns);
+                } else {
+                    multiSender->sendData(frame, origin_ns);
+                    if (PeriodRecorder* recorder = send_recorder) {
+                        recorder->mark();
+                    }
+                }
+            }
+        }
+        multiSender->collectTimestamps();
+        bool info_due = clock::now() >= next_tcp_info;
+        if (info_due) {
+            multiSender->sampleTcpInfo();
+            next_tcp_info = clock::now() + std::chrono::milliseconds(tcp_info_interval_ms);
+        }
+        // the rate controller sees backlog, drops and RTT of one endpoint, a busy standby must not throttle the primary
+        SenderStats active{};
+        SenderStats current = multiSender->getStats(&active);
+        if (current.failovers + current.fallbacks != switches) {
+            switches = current.failovers + current.fallbacks;
+            changeFilter.reset(); // the other service has not seen the last sent frame
+            if (adaptive) {
+                rateController.reset(rate_hz, active.dropped); // other path, other drop counter and RTT baseline
+            }
+        }
+        if (adaptive && (connected_now || !was_adaptive)) {
+            rateController.reset(send_rate, active.dropped); // every connection starts at the configured rate
+        }
+        was_adaptive = adaptive;
+        if (!adaptive) {
+            rate_hz = send_rate;
+        } else if (conn_state == conn_connected) {
+            rate_hz = rateController.update(clock::now(), active, multiSender->getTcpInfo());
+        }
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            stats = current;
+            stats.send_rate = rate_hz;
+            stats.rate_decreases = rateController.getDecreases();
+            stats.suppressed = changeFilter.getSuppressed();
+            stats.keepalives = changeFilter.getKeepalives();
+            stats.impaired = impairment.getDelayed();
+            stats.impair_overflow = impairment.getOverflow();
+            stats.impair_queued = static_cast<int>(impairment.getQueued());
+            if (info_due) {
+                tcp_info = multiSender->getTcpInfo();
+            }
+            if (clock::now() >= next_latency_update) { // percentiles are too costly for every frame
+                tx_latency = multiSender->getTxLatency();
+                if (multiSender->getCount() > 1) {
+                    endpoint_status = multiSender->getEndpointStatus(tx_timestamps);
+                    for (auto& endpoint : endpoint_status) { // filter, rate and failover are shared by all endpoints
+                        endpoint.stats.suppressed = stats.suppressed;
+                        endpoint.stats.keepalives = stats.keepalives;
+                        endpoint.stats.send_rate = stats.send_rate;
+                        endpoint.stats.rate_decreases = stats.rate_decreases;
+                        endpoint.stats.on_standby = stats.on_standby;
+                        endpoint.stats.failovers = stats.failovers;
+                        endpoint.stats.fallbacks = stats.fallbacks;
+                        endpoint.stats.failover_ms = stats.failover_ms;
+                    }
+                } else {
+                    endpoint_status.clear();
+                }
+                if (adaptive) {
+                    rate_history = rateController.getHistory();
+                } else {
+                    rate_history.clear();
+                }
+                next_latency_update = clock::now() + std::chrono::milliseconds(100);
+            }
+        }
+
+        auto period = std::chrono::nanoseconds(1000000000LL / rate_hz);
+        next += period;
+        auto now = clock::now();
+        if (next < now) {
+            next = now; // fell behind, do not try to catch up with a burst
+        }
+        // emulated frames are released at their own time between the ticks
+        while (running) {
+            auto wake = std::min(next, impairment.nextRelease());
+            multiSender->waitWritable(wake); // returns early when no write is stalled
+            std::this_thread::sleep_until(wake);
+            if (wake >= next) {
+                break;
+            }
+            releaseImpaired(clock::now());
+        }
+    }
+}
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef SENDER_THREAD_H
+#define SENDER_THREAD_H
+
+#include "structs.h"
+#include "multi_sender.h"
+#include "change_filter.h"
+#include "impairment.h"
+#include "rate_controller.h"
+#include "period_recorder.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Sends the newest published r_remote_data at a fixed rate, independent of the render loop
+class SenderThread {
+    std::unique_ptr<MultiSender> multiSender;
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<int> send_rate; // Hz
+
+    std::mutex data_mutex;
+    r_remote_data latest{};
+    bool has_data;
+    uint64_t latest_origin; // CLOCK_REALTIME of the oldest input not sent yet, 0 if none
+
+    std::mutex conn_mutex;
+    std::string server_ip;
+    std::string standby_ip;
+    std::atomic<bool> connect_requested; // what the user wants
+    bool connect_pending; // new request not yet seen by the sender thread, guarded by conn_mutex
+    std::atomic<int> connect_timeout_ms;
+    std::atomic<bool> auto_reconnect;
+    std::atomic<ConnectionState> conn_state;
+    std::atomic<int> retry_in_ms;
+    std::atomic<int> protocol_version;
+    std::atomic<SendMode> send_mode;
+    std::atomic<int> max_backlog_frames;
+    std::atomic<TransportBackend> backend;
+    std::atomic<bool> uring_sqpoll;
+    std::atomic<bool> tx_timestamps;
+    std::atomic<bool> frame_stamps;
+    std::atomic<int> tcp_info_interval_ms;
+
+    std::mutex filter_mutex;
+    bool send_on_change; // guarded by filter_mutex
+    DeadBand dead_band; // guarded by filter_mutex
+    ChangeFilter changeFilter; // used only by the sender thread
+
+    std::mutex impair_mutex;
+    ImpairmentProfile impair_profile; // guarded by impair_mutex
+    Impairment impairment; // used only by the sender thread
+
+    std::mutex rate_mutex;
+    bool adaptive_rate; // guarded by rate_mutex
+    RateControl rate_control; // guarded by rate_mutex
+    RateController rateController; // used only by the sender thread
+
+    std::mutex stats_mutex;
+    SenderStats stats{};
+    TxLatencyStats tx_latency{};
+    TcpInfoSample tcp_info{};
+    std::vector<EndpointStatus> endpoint_status;
+    std::vector<float> rate_history;
+
+    std::atomic<PeriodRecorder*> send_recorder; // marked by the sender thread after every sent frame
+
+    void run();
+    void updateConnection();
+    void releaseImpaired(std::chrono::steady_clock::time_point now);
+public:
+    SenderThread();
+    ~SenderThread();
+    void start(int rate_hz);
+    void stop();
+    void setRate(int rate_hz);
+    void publish(const r_remote_data& data, uint64_t origin_ns = 0); // origin_ns: input time, ends up in frame stamps
+    void requestConnect(const std::string& ip, const std::string& standby = "");
+    void requestDisconnect();
+    void setConnectOptions(int timeout_ms, bool reconnect);
+    void setSendMode(SendMode mode, int max_backlog);
+    int setProtocol(int version); // -1 if the version is not supported
+    void setBackend(TransportBackend backend, bool sqpoll);
+    void setTxTimestamps(bool enable);
+    void setFrameStamps(bool enable);
+    void setTcpInfoInterval(int interval_ms);
+    void setSendOnChange(bool enable, const DeadBand& band);
+    void setImpairment(const ImpairmentProfile& profile);
+    void setAdaptiveRate(bool enable, const RateControl& control); // setRate() gives the start value
+    void setSendRecorder(PeriodRecorder* recorder); // nullptr to stop, read the recorder only after stop()
+    bool isConnectRequested();
+    bool isConnected();
+    ConnectionState getState();
+    int getRetryDelay();
+    SenderStats getStats();
+    TxLatencyStats getTxLatency();
+    TcpInfoSample getTcpInfo();
+    std::vector<EndpointStatus> getEndpoints(); // empty with a single endpoint
+    std::vector<float> getRateHistory(); // empty unless the adaptive rate is enabled
+};
+
+static const int min_send_rate = 10;
+static const int max_send_rate = 2000;
+
+#endif // SENDER_THREAD_H
@@ -4,7 +4,9 @@
  */
 
 #include "settings.h"
+#include "fixed_step.h"
 
+#include <algorithm>
 #include <fstream>
 
 fs::path getConfigDir() {
@@ -36,6 +38,38 @@ void saveConfig(const fs::path& config_dir, const Config& config) {
     out << "GamepadAxisSensivity=" << config.gamepad_axis_sens<< "\n";
     out << "GamepadDeadZone=" << config.gamepad_dead_zone<< "\n";
     out << "ServerIP=" << config.server_ip<< "\n";
+    out << "StandbyIP=" << config.standby_ip << "\n";
+    out << "SendRate=" << config.send_rate << "\n";
+    out << "SimulationRate=" << config.sim_rate << "\n";
+    out << "AdaptiveRate=" << config.adaptive_rate << "\n";
+    out << "AdaptiveMinRate=" << config.adaptive_min_rate << "\n";
+    out << "AdaptiveMaxRate=" << config.adaptive_max_rate << "\n";
+    out << "AdaptiveRttMargin=" << config.adaptive_rtt_margin_ms << "\n";
+    out << "ProtocolVersion=" << config.protocol_version << "\n";
+    out << "ConnectTimeout=" << config.connect_timeout_ms << "\n";
+    out << "AutoReconnect=" << config.auto_reconnect << "\n";
+    out << "SendMode=" << config.send_mode << "\n";
+    out << "MaxBacklogFrames=" << config.max_backlog_frames << "\n";
+    out << "Backend=" << config.backend << "\n";
+    out << "UringSqpoll=" << config.uring_sqpoll << "\n";
+    out << "TxTimestamps=" << config.tx_timestamps << "\n";
+    out << "FrameStamps=" << config.frame_stamps << "\n";
+    out << "TcpInfoInterval=" << config.tcp_info_interval_ms << "\n";
+    out << "MetricsFile=" << config.metrics_file << "\n";
+    out << "SendOnChange=" << config.send_on_change << "\n";
+    out << "DeadBandPosition=" << config.dead_band_pos_mm << "\n";
+    out << "DeadBandAngle=" << config.dead_band_angle_deg << "\n";
+    out << "DeadBandVelocity=" << config.dead_band_vel << "\n";
+    out << "KeepaliveInterval=" << config.keepalive_ms << "\n";
+    out << "ImpairEnabled=" << config.impair_enabled << "\n";
+    out << "ImpairPreset=" << config.impair_preset << "\n";
+    out << "ImpairLatency=" << config.impair_latency_ms << "\n";
+    out << "ImpairJitter=" << config.impair_jitter_ms << "\n";
+    out << "ImpairDistribution=" << config.impair_distribution << "\n";
+    out << "ImpairStallInterval=" << config.impair_stall_interval_ms << "\n";
+    out << "ImpairStall=" << config.impair_stall_ms << "\n";
+    out << "ImpairBandwidth=" << config.impair_bandwidth_kbps << "\n";
+    out << "ImpairSeed=" << config.impair_seed << "\n";
 }
 
 Config loadConfig(const fs::path& config_dir) {
@@ -73,6 +107,70 @@ Config loadConfig(const fs::path& config_dir) {
                 config.gamepad_dead_zone = std::stof(value);
             } else if (key == "ServerIP") {
                 config.server_ip = value;
+            } else if (key == "StandbyIP") {
+                config.standby_ip = value;
+            } else if (key == "SendRate") {
+                config.send_rate = std::stoi(value);
+            } else if (key == "SimulationRate") {
+                config.sim_rate = std::clamp(std::stoi(value), min_sim_rate, max_sim_rate);
+            } else if (key == "AdaptiveRate") {
+                config.adaptive_rate = std::stoi(value) != 0;
+            } else if (key == "AdaptiveMinRate") {
+                config.adaptive_min_rate = std::clamp(std::stoi(value), 1, 2000);
+            } else if (key == "AdaptiveMaxRate") {
+                config.adaptive_max_rate = std::clamp(std::stoi(value), 1, 2000);
+            } else if (key == "AdaptiveRttMargin") {
+                config.adaptive_rtt_margin_ms = std::stof(value);
+            } else if (key == "ProtocolVersion") {
+                config.protocol_version = std::stoi(value);
+            } else if (key == "ConnectTimeout") {
+                config.connect_timeout_ms = std::stoi(value);
+            } else if (key == "AutoReconnect") {
+                config.auto_reconnect = std::stoi(value) != 0;
+            } else if (key == "SendMode") {
+                config.send_mode = std::stoi(value) == send_queue ? send_queue : send_latest;
+            } else if (key == "MaxBacklogFrames") {
+                config.max_backlog_frames = std::stoi(value);
+            } else if (key == "Backend") {
+                config.backend = std::stoi(value) == backend_uring ? backend_uring : backend_socket;
+            } else if (key == "UringSqpoll") {
+                config.uring_sqpoll = std::stoi(value) != 0;
+            } else if (key == "TxTimestamps") {
+                config.tx_timestamps = std::stoi(value) != 0;
+            } else if (key == "FrameStamps") {
+                config.frame_stamps = std::stoi(value) != 0;
+            } else if (key == "TcpInfoInterval") {
+                config.tcp_info_interval_ms = std::stoi(value);
+            } else if (key == "MetricsFile") {
+                config.metrics_file = value;
+            } else if (key == "SendOnChange") {
+                config.send_on_change = std::stoi(value) != 0;
+            } else if (key == "DeadBandPosition") {
+                config.dead_band_pos_mm = std::stof(value);
+            } else if (key == "DeadBandAngle") {
+                config.dead_band_angle_deg = std::stof(value);
+            } else if (key == "DeadBandVelocity") {
+                config.dead_band_vel = std::stof(value);
+            } else if (key == "KeepaliveInterval") {
+                config.keepalive_ms = std::stoi(value);
+            } else if (key == "ImpairEnabled") {
+                config.impair_enabled = std::stoi(value) != 0;
+            } else if (key == "ImpairPreset") {
+                config.impair_preset = std::stoi(value);
+            } else if (key == "ImpairLatency") {
+                config.impair_latency_ms = std::stof(value);
+            } else if (key == "ImpairJitter") {
+                config.impair_jitter_ms = std::stof(value);
+            } else if (key == "ImpairDistribution") {
+                config.impair_distribution = static_cast<LatencyDistribution>(std::clamp(std::stoi(value), 0, 3));
+            } else if (key == "ImpairStallInterval") {
+                config.impair_stall_interval_ms = std::stof(value);
+            } else if (key == "ImpairStall") {
+                config.impair_stall_ms = std::stof(value);
+            } else if (key == "ImpairBandwidth") {
+                config.impair_bandwidth_kbps = std::stof(value);
+            } else if (key == "ImpairSeed") {
+                config.impair_seed = std::stoi(value);
             }
         }
     }
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "shm_ring.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static size_t headerSize(void) {
+    return (sizeof(ShmRingHeader) + 63) & ~size_t(63); // frames start on their own cache line
+}
+
+static bool processAlive(int32_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+ShmRing::ShmRing() {
+    header = nullptr;
+    frames = nullptr;
+    map_size = 0;
+    receiver = false;
+    sender = false;
+    cached_tail = 0;
+    cached_head = 0;
+}
+
+ShmRing::~ShmRing() {
+    close();
+}
+
+int ShmRing::map(int fd, size_t size) {
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the object alive
+    if (mem == MAP_FAILED) {
+        std::cerr << "Cannot map " << name << ": " << strerror(errno) << std::endl;
+        return -1;
+    }
+    header = static_cast<ShmRingHeader*>(mem);
+    frames = reinterpret_cast<r_remote_data*>(static_cast<char*>(mem) + headerSize());
+    map_size = size;
+    return 0;
+}
+
+int ShmRing::create(const std::string& shm_name, uint32_t capacity) {
+    close();
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        std::cerr << "Ring capacity must be a power of two" << std::endl;
+        return -1;
+    }
+    name = shm_name;
+    shm_unlink(name.c_str()); // a leftover from a crashed receiver would confuse the sender
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        std::cerr << "Cannot create " << name << ": " << strerror(errno) << std::endl;
+        return -1;
+    }
+    size_t size = headerSize() + size_t(capacity) * sizeof(r_remote_data);
+    if (ftruncate(fd, size) < 0) {
+        std::cerr << "Cannot resize " << name << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return -1;
+    }
+    if (map(fd, size) < 0) {
+        shm_unlink(name.c_str());
+        return -1;
+    }
+    receiver = true;
+    new (header) ShmRingHeader{}; // ftruncate zeroed it, this only makes the atomics formally alive
+    header->frame_size = sizeof(r_remote_data);
+    header->capacity = capacity;
+    header->receiver_pid.store(getpid());
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = shm_ring_magic;
+    return 0;
+}
+
+int ShmRing::attach(const std::string& shm_name) {
+    close();
+    name = shm_name;
+    int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1; // receiver not started yet, the caller retries
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < headerSize()) {
+        ::close(fd);
+        return -1;
+    }
+    if (map(fd, st.st_size) < 0) {
+        return -1;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->magic != shm_ring_magic || header->frame_size != sizeof(r_remote_data)
+        || headerSize() + size_t(header->capacity) * sizeof(r_remote_data) > map_size) {
+        std::cerr << name << " is not a compatible pose ring" << std::endl;
+        close();
+        return -1;
+    }
+    // the ring has a single producer, take over only from a sender that died
+    int32_t owner = header->sender_pid.load();
+    if ((owner != 0 && processAlive(owner)) || !header->sender_pid.compare_exchange_strong(owner, getpid())) {
+        std::cerr << name << " already has a sender" << std::endl;
+        close();
+        return -1;
+    }
+    sender = true;
+    cached_tail = header->tail.load(std::memory_order_acquire);
+    return 0;
+}
+
+void ShmRing::close(void) {
+    if (!header) {
+        return;
+    }
+    if (receiver) {
+        header->receiver_pid.store(0);
+        shm_unlink(name.c_str());
+    } else if (sender) {
+        header->sender_pid.store(0);
+    }
+    munmap(header, map_size);
+    header = nullptr;
+    frames = nullptr;
+    receiver = false;
+    sender = false;
+}
+
+bool ShmRing::isOpen(void) {
+    return header != nullptr;
+}
+
+bool ShmRing::isPeerAlive(void) {
+    if (!header) {
+        return false;
+    }
+    if (receiver) {
+        return header->sender_pid.load() != 0;
+    }
+    return processAlive(header->receiver_pid.load());
+}
+
+bool ShmRing::push(const r_remote_data& frame) {
+    uint64_t head = header->head.load(std::memory_order_relaxed);
+    if (head - cached_tail >= header->capacity) {
+        cached_tail = header->tail.load(std::memory_order_acquire);
+        if (head - cached_tail >= header->capacity) {
+            return false;
+        }
+    }
+    frames[head & (header->capacity - 1)] = frame;
+    header->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool ShmRing::pop(r_remote_data& frame) {
+    uint64_t tail = header->tail.load(std::memory_order_relaxed);
+    if (tail == cached_head) {
+        cached_head = header->head.load(std::memory_order_acquire);
+        if (tail == cached_head) {
+            return false;
+        }
+    }
+    frame = frames[tail & (header->capacity - 1)];
+    header->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+uint32_t ShmRing::getQueued(void) {
+    if (!header) {
+        return 0;
+    }
+    return static_cast<uint32_t>(header->head.load(std::memory_order_acquire)
+                                 - header->tail.load(std::memory_order_acquire));
+}
+
+uint32_t ShmRing::getCapacity(void) {
+    return header ? header->capacity : 0;
+}
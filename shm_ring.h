@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include "structs.h"
+
+#include <atomic>
+#include <string>
+
+// Lives at the start of the shared memory object, frames follow it
+struct ShmRingHeader {
+    uint64_t magic; // written last by the receiver, the ring is usable once it matches
+    uint32_t frame_size;
+    uint32_t capacity; // power of two
+    alignas(64) std::atomic<uint64_t> head; // frames written, only the sender stores it
+    alignas(64) std::atomic<uint64_t> tail; // frames read, only the receiver stores it
+    alignas(64) std::atomic<int32_t> receiver_pid;
+    std::atomic<int32_t> sender_pid; // 0 while no sender is attached
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory ring needs lock-free 64 bit atomics");
+
+// Single producer, single consumer ring of r_remote_data in POSIX shared memory
+class ShmRing {
+    std::string name;
+    ShmRingHeader* header;
+    r_remote_data* frames;
+    size_t map_size;
+    bool receiver; // created the object, unlinks it on close
+    bool sender; // holds sender_pid, releases it on close
+    uint64_t cached_tail; // sender side, refreshed only when the ring looks full
+    uint64_t cached_head; // receiver side, refreshed only when the ring looks empty
+
+    int map(int fd, size_t size);
+public:
+    ShmRing();
+    ~ShmRing();
+    int create(const std::string& shm_name, uint32_t capacity); // receiver side
+    int attach(const std::string& shm_name); // sender side, -1 if missing or another sender is attached
+    void close(void);
+    bool isOpen(void);
+    bool isPeerAlive(void); // the other side still exists
+    bool push(const r_remote_data& frame); // false if full
+    bool pop(r_remote_data& frame); // false if empty
+    uint32_t getQueued(void);
+    uint32_t getCapacity(void);
+};
+
+// "mndshm1" in little-endian byte order, built from the bytes instead of reading the literal through a pointer
+static const uint64_t shm_ring_magic = uint64_t('m') | uint64_t('n') << 8 | uint64_t('d') << 16 | uint64_t('s') << 24
+                                       | uint64_t('h') << 32 | uint64_t('m') << 40 | uint64_t('1') << 48;
+
+#endif // SHM_RING_H
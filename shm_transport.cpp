@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "shm_transport.h"
+
+#include <cstring>
+#include <thread>
+
+ShmTransport::ShmTransport() {
+    state = conn_disconnected;
+}
+
+ShmTransport::~ShmTransport() {
+    close();
+}
+
+/* The ring has no handshake, it is "connected" once the receiver created it */
+int ShmTransport::open(const TransportAddress& address, int) {
+    close();
+    if (ring.attach(address.path) < 0) {
+        last_error = "shared memory ring not available";
+        return 0;
+    }
+    next_peer_check = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    state = conn_connected;
+    return 0;
+}
+
+ConnectionState ShmTransport::update(void) {
+    auto now = std::chrono::steady_clock::now();
+    if (state == conn_connected && now >= next_peer_check) {
+        if (!ring.isPeerAlive()) {
+            last_error = "receiver closed the ring";
+            close();
+        }
+        next_peer_check = now + std::chrono::milliseconds(100);
+    }
+    return state;
+}
+
+/* A frame is copied whole, so nothing is ever half written */
+int ShmTransport::write(const void* buf, size_t len) {
+    if (len != sizeof(r_remote_data)) {
+        last_error = "the shared memory ring only carries mndrmt3 frames";
+        return -1;
+    }
+    r_remote_data frame;
+    memcpy(&frame, buf, len);
+    return ring.push(frame) ? static_cast<int>(len) : 0;
+}
+
+bool ShmTransport::isWriting(void) {
+    return false;
+}
+
+int ShmTransport::flush(int timeout_ms) {
+    // nothing to sleep on, the receiver only moves the tail
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (ring.getQueued() >= ring.getCapacity()) {
+        if (!ring.isPeerAlive() || std::chrono::steady_clock::now() >= until) {
+            return 0;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return 1;
+}
+
+int ShmTransport::getBacklog(void) {
+    if (!ring.isOpen()) {
+        return 0;
+    }
+    return static_cast<int>(ring.getQueued() * sizeof(r_remote_data));
+}
+
+uint64_t ShmTransport::getSyscalls(void) {
+    return 0; // the ring is plain shared memory
+}
+
+int ShmTransport::getFd(void) {
+    return -1;
+}
+
+int ShmTransport::getPollFd(uint32_t&) {
+    return -1;
+}
+
+std::string ShmTransport::describe(void) {
+    return transportName(transport_shm);
+}
+
+const std::string& ShmTransport::getError(void) {
+    return last_error;
+}
+
+void ShmTransport::close(void) {
+    ring.close();
+    state = conn_disconnected;
+}
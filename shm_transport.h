@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef SHM_TRANSPORT_H
+#define SHM_TRANSPORT_H
+
+#include "transport.h"
+#include "shm_ring.h"
+
+#include <chrono>
+
+// Whole frames into the ShmRing of a receiver on the same host
+class ShmTransport : public Transport {
+    ShmRing ring;
+    ConnectionState state;
+    std::chrono::steady_clock::time_point next_peer_check;
+    std::string last_error;
+public:
+    ShmTransport();
+    ~ShmTransport() override;
+    int open(const TransportAddress& address, int connect_timeout_ms) override;
+    ConnectionState update(void) override;
+    int write(const void* buf, size_t len) override; // whole mndrmt3 frames, the ring slot size
+    bool isWriting(void) override;
+    int flush(int timeout_ms) override;
+    int getBacklog(void) override; // frames not consumed yet, in bytes
+    uint64_t getSyscalls(void) override;
+    int getFd(void) override;
+    int getPollFd(uint32_t& events) override;
+    std::string describe(void) override;
+    const std::string& getError(void) override;
+    void close(void) override;
+};
+
+#endif // SHM_TRANSPORT_H
@@ -0,0 +1,312 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "socket_transport.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <linux/sockios.h> // SIOCOUTQ
+#include <poll.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+SocketTransport::SocketTransport() {
+    numeric_host = true;
+    resolving = false;
+    next_candidate = 0;
+    sockfd = -1;
+    state = conn_disconnected;
+    connect_addr_len = 0;
+    connect_timeout_ms = 2000;
+    syscalls = 0;
+}
+
+SocketTransport::~SocketTransport() {
+    close();
+}
+
+void SocketTransport::setResolver(std::shared_ptr<Resolver> resolver) {
+    this->resolver = resolver;
+}
+
+int SocketTransport::open(const TransportAddress& address, int connect_timeout_ms) {
+    close();
+    this->address = address;
+    this->connect_timeout_ms = connect_timeout_ms;
+    connect_addr = sockaddr_storage{};
+    candidates.clear();
+    if (address.kind == transport_unix) {
+        sockaddr_un* un = reinterpret_cast<sockaddr_un*>(&connect_addr);
+        un->sun_family = AF_UNIX;
+        strncpy(un->sun_path, address.path.c_str(), sizeof(un->sun_path) - 1);
+        connect_addr_len = sizeof(sockaddr_un);
+    } else {
+        ResolvedAddress numeric;
+        numeric_host = parseNumericHost(address.host, address.port, numeric);
+        if (numeric_host) {
+            candidates.push_back(numeric);
+        }
+    }
+    state = conn_connecting;
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(connect_timeout_ms);
+    if (address.kind == transport_tcp && !numeric_host) {
+        resolving = true;
+        return pollResolver();
+    }
+    return startAttempts();
+}
+
+/* Never blocks, a name not in the cache keeps the transport connecting until the worker answers */
+int SocketTransport::pollResolver(void) {
+    if (!resolver) {
+        resolver = std::make_shared<Resolver>();
+    }
+    int res = resolver->lookup(address.host, address.port, candidates);
+    if (res == 0) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            failed("name resolution timeout");
+        }
+        return 0;
+    }
+    resolving = false;
+    if (res < 0) {
+        failed("cannot resolve host");
+        return 0;
+    }
+    if (startAttempts() < 0) {
+        failed("socket creation failed"); // the lookup succeeded, so a later attempt may get a socket
+    }
+    return 0;
+}
+
+int SocketTransport::startAttempts(void) {
+    if (candidates.size() > 1) {
+        // happy eyeballs: a new address every attempt_delay_ms, the first one to connect wins
+        next_candidate = 0;
+        last_error = "no usable address";
+        startNextAttempt();
+        if (attempts.empty()) {
+            failed(last_error);
+        }
+        return 0;
+    }
+    if (address.kind == transport_tcp) {
+        connect_addr = candidates[0].addr;
+        connect_addr_len = candidates[0].len;
+    }
+    return connectOne();
+}
+
+int SocketTransport::connectOne(void) {
+    sockfd = socket(connect_addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (sockfd < 0) {
+        std::cerr << "Socked creation failed!" << std::endl;
+        state = conn_disconnected;
+        return -1;
+    }
+    // a Unix socket with a full listen queue fails with EAGAIN, retried like a refused connection
+    if (connect(sockfd, (sockaddr*)&connect_addr, connect_addr_len) < 0 && errno != EINPROGRESS) {
+        failed(strerror(errno));
+    }
+    return 0;
+}
+
+void SocketTransport::pollConnect(void) {
+    pollfd pfd {sockfd, POLLOUT, 0};
+    if (poll(&pfd, 1, 0) > 0) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err == 0) {
+            connected();
+            state = conn_connected;
+        } else {
+            failed(strerror(err));
+        }
+    } else if (std::chrono::steady_clock::now() >= deadline) {
+        failed("timeout");
+    }
+}
+
+void SocketTransport::connected(void) {
+    if (address.kind == transport_tcp) {
+        int one = 1; // poses are tiny and time critical, do not let Nagle hold them back
+        setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+}
+
+/* Racing attempts always use plain non-blocking connects, the winner is handed to connected() */
+void SocketTransport::startNextAttempt(void) {
+    while (next_candidate < candidates.size()) {
+        size_t index = next_candidate++;
+        const ResolvedAddress& candidate = candidates[index];
+        int fd = socket(candidate.addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (fd < 0) {
+            last_error = strerror(errno);
+            continue;
+        }
+        if (connect(fd, (const sockaddr*)&candidate.addr, candidate.len) < 0 && errno != EINPROGRESS) {
+            last_error = strerror(errno); // e.g. no IPv6 route, try the next address right away
+            ::close(fd);
+            continue;
+        }
+        attempts.push_back({fd, index});
+        next_attempt = std::chrono::steady_clock::now() + std::chrono::milliseconds(attempt_delay_ms);
+        return;
+    }
+}
+
+void SocketTransport::pollAttempts(void) {
+    std::vector<pollfd> pfds;
+    for (const auto& attempt : attempts) {
+        pfds.push_back({attempt.fd, POLLOUT, 0});
+    }
+    if (poll(pfds.data(), pfds.size(), 0) > 0) {
+        for (size_t i = 0; i < pfds.size(); i++) {
+            if (!pfds[i].revents) {
+                continue;
+            }
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(pfds[i].fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err == 0) {
+                sockfd = pfds[i].fd;
+                connect_addr = candidates[attempts[i].index].addr;
+                connect_addr_len = candidates[attempts[i].index].len;
+                attempts.erase(attempts.begin() + i);
+                closeAttempts();
+                connected();
+                state = conn_connected;
+                return;
+            }
+            last_error = strerror(err);
+            ::close(pfds[i].fd);
+            attempts[i].fd = -1;
+        }
+        attempts.erase(std::remove_if(attempts.begin(), attempts.end(),
+                                      [](const ConnectAttempt& a) { return a.fd < 0; }), attempts.end());
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+        failed("timeout");
+        return;
+    }
+    if (attempts.empty() || now >= next_attempt) {
+        startNextAttempt(); // a failed attempt does not wait for the delay
+    }
+    if (attempts.empty()) {
+        failed(last_error);
+    }
+}
+
+void SocketTransport::closeAttempts(void) {
+    for (const auto& attempt : attempts) {
+        ::close(attempt.fd);
+    }
+    attempts.clear();
+}
+
+void SocketTransport::failed(const std::string& reason) {
+    last_error = reason;
+    close();
+}
+
+ConnectionState SocketTransport::update(void) {
+    if (state != conn_connecting) {
+        return state;
+    }
+    if (resolving) {
+        pollResolver();
+    } else if (!attempts.empty()) {
+        pollAttempts();
+    } else {
+        pollConnect();
+    }
+    return state;
+}
+
+int SocketTransport::write(const void* buf, size_t len) {
+    size_t off = 0;
+    while (off < len) {
+        // MSG_NOSIGNAL: a restarted monado-service must not kill us with SIGPIPE
+        syscalls++;
+        ssize_t n = send(sockfd, static_cast<const char*>(buf) + off, len - off, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            last_error = strerror(errno);
+            return -1;
+        }
+        off += n;
+    }
+    return static_cast<int>(off);
+}
+
+bool SocketTransport::isWriting(void) {
+    return false; // send() either takes the bytes or not
+}
+
+int SocketTransport::flush(int timeout_ms) {
+    pollfd pfd {sockfd, POLLOUT, 0};
+    syscalls++;
+    return poll(&pfd, 1, timeout_ms);
+}
+
+int SocketTransport::getBacklog(void) {
+    int outq = 0;
+    if (sockfd >= 0) {
+        syscalls++;
+        if (ioctl(sockfd, SIOCOUTQ, &outq) < 0) {
+            outq = 0;
+        }
+    }
+    return outq;
+}
+
+uint64_t SocketTransport::getSyscalls(void) {
+    return syscalls;
+}
+
+int SocketTransport::getFd(void) {
+    return state == conn_connected ? sockfd : -1;
+}
+
+int SocketTransport::getPollFd(uint32_t& events) {
+    events = EPOLLOUT;
+    return getFd();
+}
+
+std::string SocketTransport::describe(void) {
+    std::string text = transportName(address.kind);
+    if (address.kind == transport_tcp && !numeric_host) {
+        text += " " + formatSockaddr({connect_addr, connect_addr_len}); // the address that won the race
+    }
+    return text;
+}
+
+const std::string& SocketTransport::getError(void) {
+    return last_error;
+}
+
+void SocketTransport::close(void) {
+    closeAttempts();
+    resolving = false;
+    if (sockfd >= 0) {
+        ::close(sockfd);
+        sockfd = -1;
+    }
+    state = conn_disconnected;
+}
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef SOCKET_TRANSPORT_H
+#define SOCKET_TRANSPORT_H
+
+#include "transport.h"
+#include "resolver.h"
+
+#include <chrono>
+#include <memory>
+#include <sys/socket.h>
+#include <vector>
+
+// TCP or Unix stream socket with plain non-blocking BSD calls
+class SocketTransport : public Transport {
+    std::shared_ptr<Resolver> resolver; // created on first use unless shared by setResolver()
+    bool numeric_host; // literal address, no lookup needed
+    bool resolving;
+    std::vector<ResolvedAddress> candidates; // tcp addresses to try, in happy eyeballs order
+    struct ConnectAttempt {
+        int fd;
+        size_t index; // into candidates
+    };
+    std::vector<ConnectAttempt> attempts; // racing non-blocking connects, several addresses only
+    size_t next_candidate;
+    std::chrono::steady_clock::time_point next_attempt; // start the next address if nothing connected by then
+
+    int pollResolver(void);
+    int startAttempts(void);
+    void startNextAttempt(void);
+    void pollAttempts(void);
+    void closeAttempts(void);
+protected:
+    int sockfd;
+    ConnectionState state;
+    TransportAddress address;
+    sockaddr_storage connect_addr{}; // must outlive an asynchronous connect
+    socklen_t connect_addr_len;
+    int connect_timeout_ms;
+    std::chrono::steady_clock::time_point deadline; // connect timeout, the lookup included
+    std::string last_error;
+    uint64_t syscalls;
+
+    virtual int connectOne(void); // connects sockfd to connect_addr, -1 if no socket could be created
+    virtual void pollConnect(void); // progress of the connect started by connectOne()
+    virtual void connected(void); // sockfd won, called before the state changes
+    void failed(const std::string& reason);
+public:
+    SocketTransport();
+    ~SocketTransport() override;
+    void setResolver(std::shared_ptr<Resolver> resolver);
+    int open(const TransportAddress& address, int connect_timeout_ms) override;
+    ConnectionState update(void) override;
+    int write(const void* buf, size_t len) override;
+    bool isWriting(void) override;
+    int flush(int timeout_ms) override;
+    int getBacklog(void) override; // SIOCOUTQ, unsent plus unacknowledged bytes
+    uint64_t getSyscalls(void) override;
+    int getFd(void) override;
+    int getPollFd(uint32_t& events) override;
+    std::string describe(void) override;
+    const std::string& getError(void) override;
+    void close(void) override;
+};
+
+static const int attempt_delay_ms = 250; // RFC 8305 connection attempt delay
+
+#endif // SOCKET_TRANSPORT_H
@@ -9,9 +9,11 @@
 
 #include <cstdint> // for fixed size integer types
 #include <string>
+#include <vector>
 
 #define	MONADO_PORT	4242
 #define R_HEADER_VALUE (*(uint64_t *)"mndrmt3\0") // used by Monado since e4931a46bd0a161a15a1a601f927d1dec30d23ce
+#define R_HEADER_VALUE_V2 (*(uint64_t *)"mndrmt2\0") // before that, see wire_protocol.cpp
 
 struct xrt_vec1 {
     float x;
@@ -117,6 +119,106 @@ enum InputConsumer {
     right_controller = 2
 };
 
+// how frames reach the receiver, selected by the address prefix
+enum TransportKind {
+    transport_tcp = 0, // ip[:port]
+    transport_unix = 1, // unix:/path/to/socket
+    transport_shm = 2 // shm:/name, SPSC ring created by the receiver
+};
+
+// delay distribution of the impairment emulator, jitter is its scale
+enum LatencyDistribution {
+    dist_constant = 0,
+    dist_uniform = 1, // latency +/- jitter
+    dist_normal = 2, // standard deviation jitter
+    dist_pareto = 3 // long tail above latency, mean jitter / 2
+};
+
+// state of the connection to monado-service
+enum ConnectionState {
+    conn_disconnected = 0,
+    conn_connecting = 1,
+    conn_connected = 2,
+    conn_reconnect_wait = 3
+};
+
+// how DataSender treats frames when the receiver does not keep up
+enum SendMode {
+    send_queue = 0, // every frame is sent, the socket buffer may hold stale poses
+    send_latest = 1 // at most max_backlog_frames wait in the kernel, older frames are skipped
+};
+
+// how DataSender talks to the kernel
+enum TransportBackend {
+    backend_socket = 0, // plain BSD socket calls
+    backend_uring = 1 // io_uring with registered buffers, falls back to backend_socket if unavailable
+};
+
+// counters reported by DataSender
+struct SenderStats {
+    uint64_t sent = 0; // frames fully written to the socket
+    uint64_t dropped = 0; // frames replaced by a newer one before being sent
+    uint64_t coalesced = 0; // sends that superseded one or more dropped frames
+    uint64_t partial_writes = 0; // short writes completed later
+    uint64_t syscalls = 0; // send, ioctl, poll and io_uring_enter calls made by the send path
+    uint64_t suppressed = 0; // frames not sent in send-on-change mode, within the dead-band
+    uint64_t keepalives = 0; // unchanged frames resent only to keep the connection alive
+    uint64_t impaired = 0; // frames that went through the impairment emulator
+    uint64_t impair_overflow = 0; // frames dropped because the emulator queue was full
+    int impair_queued = 0; // frames waiting in the emulator
+    int backlog_bytes = 0; // unsent plus unacknowledged bytes in the socket (SIOCOUTQ), frames not consumed for shm
+    int send_rate = 0; // Hz the sender thread currently runs at, follows the adaptive controller
+    uint64_t rate_decreases = 0; // multiplicative cuts of the adaptive send rate
+    bool on_standby = false; // frames go to the warm standby, no primary is connected
+    uint64_t failovers = 0; // switches from the primaries to the standby
+    uint64_t fallbacks = 0; // switches back once a primary reconnected
+    double failover_ms = 0.0; // last time from the first frame no primary took to the standby's first one
+    TransportBackend backend = backend_socket; // backend actually in use
+};
+
+// percentiles of a LatencyHistogram
+struct LatencySummary {
+    uint64_t count = 0;
+    double p50_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+};
+
+// where a pose spends its time on this host, from kernel TX timestamps (SO_TIMESTAMPING)
+struct TxLatencyStats {
+    bool enabled = false;
+    LatencySummary user; // sendData() until the frame is written to the socket (our process)
+    LatencySummary stack; // written until it enters the packet scheduler (socket buffer, TCP)
+    LatencySummary qdisc; // packet scheduler until handed to the driver
+    LatencySummary total; // sendData() until handed to the driver
+    LatencySummary ack; // written until acknowledged by the receiver's kernel
+};
+
+// connection health read with getsockopt(TCP_INFO)
+struct TcpInfoSample {
+    bool valid = false;
+    uint32_t rtt_us = 0; // smoothed round trip time
+    uint32_t rtt_var_us = 0;
+    uint32_t retransmits = 0; // unrecovered retransmission timeouts in a row
+    uint32_t total_retrans = 0;
+    uint32_t lost = 0; // segments considered lost right now
+    uint32_t cwnd = 0; // congestion window, segments
+    uint32_t unacked = 0; // segments in flight
+    int unacked_bytes = 0;
+    uint64_t delivery_rate = 0; // bytes/s
+};
+
+// one monado-service instance when fanning out to several endpoints
+struct EndpointStatus {
+    std::string address; // as given in Config::server_ip
+    ConnectionState state = conn_disconnected;
+    int retry_in_ms = 0;
+    SenderStats stats{};
+    TxLatencyStats tx_latency{};
+    TcpInfoSample tcp_info{};
+    bool standby = false; // warm standby, idle while a primary is connected
+};
+
 struct Config {
     float hmd_lin_vel;
     float hmd_ang_vel;
@@ -125,12 +227,53 @@ struct Config {
     float mouse_sens;
     float gamepad_axis_sens;
     float gamepad_dead_zone;
-    std::string server_ip;
+    std::string server_ip; // comma separated list of host[:port], [v6]:port, unix:/path or shm:/name to send the same stream to several services
+    std::string standby_ip = ""; // pre-connected endpoint that takes over when no primary is connected
+    int send_rate = 250; // pose frames per second sent by the sender thread, start value in adaptive mode
+    int sim_rate = 1000; // fixed simulation steps per second, independent of the GUI frame rate
+    bool adaptive_rate = false; // AIMD between the bounds below, see rate_controller.h
+    int adaptive_min_rate = 30;
+    int adaptive_max_rate = 1000;
+    float adaptive_rtt_margin_ms = 10.0f;
+    int protocol_version = 3; // see wire_protocol.h for the supported versions
+    int connect_timeout_ms = 2000;
+    bool auto_reconnect = true;
+    SendMode send_mode = send_queue; // configs without a SendMode= line keep the original delivery
+    int max_backlog_frames = 2;
+    TransportBackend backend = backend_socket;
+    bool uring_sqpoll = false; // kernel thread polls the submission queue, no syscall per frame
+    bool tx_timestamps = false; // collect kernel TX timestamps for the latency histograms
+    bool frame_stamps = false; // sequence number and send time in the protocol padding, see frame_stamp.h
+    int tcp_info_interval_ms = 250;
+    std::string metrics_file = ""; // Prometheus textfile export, empty to disable
+    bool send_on_change = false; // skip frames within the dead-band of the last sent one
+    float dead_band_pos_mm = 0.5f;
+    float dead_band_angle_deg = 0.05f;
+    float dead_band_vel = 0.01f; // m/s and rad/s
+    int keepalive_ms = 100; // minimum send interval in send-on-change mode
+    bool impair_enabled = false; // network impairment emulator, see impairment.h
+    int impair_preset = 0; // last chosen preset, the values below can be changed afterwards
+    float impair_latency_ms = 0.0f;
+    float impair_jitter_ms = 0.0f;
+    LatencyDistribution impair_distribution = dist_uniform;
+    float impair_stall_interval_ms = 0.0f;
+    float impair_stall_ms = 0.0f;
+    float impair_bandwidth_kbps = 0.0f;
+    int impair_seed = 1;
 };
 
 // state of an ImGui window
 struct WindowState {
-    bool connect_button_clicked = false;
+    bool connect_button_clicked = false; // shows Disconnect, a connection is requested
+    bool connect_pressed = false; // Connect clicked in this frame
+    bool disconnect_pressed = false; // Disconnect clicked in this frame
+    ConnectionState conn_state = conn_disconnected;
+    int retry_in_ms = 0;
+    SenderStats stats{};
+    TxLatencyStats tx_latency{};
+    TcpInfoSample tcp_info{};
+    std::vector<EndpointStatus> endpoints{}; // filled when sending to more than one service
+    std::vector<float> rate_history{}; // adaptive send rate, Hz per control interval
     bool grab_button_clicked = false;
     InputConsumer iCons = hmd;
     bool has_gamepad = false;
@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "tcp_info.h"
+
+#include <cstring>
+#include <linux/sockios.h>
+#include <linux/tcp.h> // the kernel struct has the newer fields glibc lacks
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+int readTcpInfo(int sockfd, TcpInfoSample& sample) {
+    tcp_info info;
+    memset(&info, 0, sizeof(info));
+    socklen_t len = sizeof(info);
+    if (getsockopt(sockfd, IPPROTO_TCP, TCP_INFO, &info, &len) < 0) {
+        sample.valid = false;
+        return -1;
+    }
+    sample.valid = true;
+    sample.rtt_us = info.tcpi_rtt;
+    sample.rtt_var_us = info.tcpi_rttvar;
+    sample.retransmits = info.tcpi_retransmits;
+    sample.total_retrans = info.tcpi_total_retrans;
+    sample.lost = info.tcpi_lost;
+    sample.cwnd = info.tcpi_snd_cwnd;
+    sample.unacked = info.tcpi_unacked;
+    sample.delivery_rate = info.tcpi_delivery_rate; // 0 on kernels older than 4.9
+
+    // SIOCOUTQ is unsent + unacked, tcpi_notsent_bytes is the unsent part
+    int outq = 0;
+    ioctl(sockfd, SIOCOUTQ, &outq);
+    sample.unacked_bytes = outq - static_cast<int>(info.tcpi_notsent_bytes);
+    if (sample.unacked_bytes < 0) {
+        sample.unacked_bytes = 0;
+    }
+    return 0;
+}
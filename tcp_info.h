@@ -0,0 +1,14 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef TCP_INFO_H
+#define TCP_INFO_H
+
+#include "structs.h"
+
+// One getsockopt(TCP_INFO) and one SIOCOUTQ ioctl, returns -1 if the socket is not TCP
+int readTcpInfo(int sockfd, TcpInfoSample& sample);
+
+#endif // TCP_INFO_H
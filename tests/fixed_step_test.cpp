@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "fixed_step.h"
+#include "math_helper.h"
+#include "test_helper.h"
+
+#include <cmath>
+
+static bool near(float a, float b) {
+    return std::fabs(a - b) < 1e-5f;
+}
+
+static void checkSteps(void) {
+    FixedStep fs;
+    fs.setRate(1000);
+    CHECK(fs.getStepNs() == 1000000);
+    const uint64_t t0 = 5000000000ULL;
+    CHECK(fs.advance(t0) == 0); // only starts the clock
+    CHECK(fs.advance(t0 + 400000) == 0); // 0.4 ms, no step yet
+    CHECK(near(fs.getAlpha(), 0.4f));
+    CHECK(fs.advance(t0 + 1200000) == 1); // the remainder carried over
+    CHECK(near(fs.getAlpha(), 0.2f));
+    CHECK(fs.advance(t0 + 4200000) == 3);
+    CHECK(fs.advance(t0 + 2000000000ULL) == 250); // a hitch is clipped to 250 ms
+
+    fs.setRate(1);
+    CHECK(fs.getStepNs() == 1000000000ULL / min_sim_rate);
+    fs.setRate(100000);
+    CHECK(fs.getStepNs() == 1000000000ULL / max_sim_rate);
+}
+
+/* However the time is cut into frames, the same number of steps is due by the same time */
+static void checkFrameTimes(void) {
+    const uint64_t frame_ns[] = {33333333, 16666667, 6944444, 400000};
+    const uint64_t total_ns = 2000000000ULL;
+    for (uint64_t frame : frame_ns) {
+        FixedStep fs;
+        fs.setRate(1000);
+        uint64_t t = 1000000;
+        fs.advance(t);
+        int steps = 0;
+        uint64_t jitter = 0;
+        while (t < total_ns) {
+            jitter = (jitter * 1103515245 + 12345) % (frame / 4 + 1); // keeps every frame below 250 ms
+            t = std::min(t + frame - frame / 8 + jitter, total_ns);
+            steps += fs.advance(t);
+        }
+        CHECK(steps == static_cast<int>((total_ns - 1000000) / 1000000));
+        CHECK(fs.getAlpha() >= 0.0f && fs.getAlpha() <= 1.0f);
+    }
+}
+
+static void checkInterpolate(void) {
+    xrt_pose a{};
+    a.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
+    a.position = {0.0f, 1.0f, 0.0f};
+    xrt_pose b{};
+    b.orientation = quatFromYXZ(static_cast<float>(M_PI) / 2.0f, 0.0f, 0.0f);
+    b.position = {2.0f, 1.0f, -4.0f};
+
+    xrt_pose p = poseInterpolate(a, b, 0.0f);
+    CHECK(near(p.position.x, 0.0f) && near(p.orientation.w, 1.0f));
+    p = poseInterpolate(a, b, 1.0f);
+    CHECK(near(p.position.z, -4.0f) && near(p.orientation.y, b.orientation.y) && near(p.orientation.w, b.orientation.w));
+    p = poseInterpolate(a, b, 0.5f);
+    CHECK(near(p.position.x, 1.0f) && near(p.position.y, 1.0f) && near(p.position.z, -2.0f));
+    auto [yaw, pitch, roll] = quatToYXZ(p.orientation);
+    CHECK(near(yaw, static_cast<float>(M_PI) / 4.0f) && near(pitch, 0.0f) && near(roll, 0.0f)); // slerp, not lerp
+}
+
+int main() {
+    checkSteps();
+    checkFrameTimes();
+    checkInterpolate();
+    return test_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "metrics_exporter.h"
+#include "test_helper.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+static std::string exportText(const SenderStats& stats, const TcpInfoSample& info) {
+    std::string path = "/tmp/mndset-metrics-test-" + std::to_string(getpid()) + ".prom";
+    MetricsExporter metrics;
+    metrics.setPath(path);
+    metrics.begin();
+    metrics.addConnection(conn_connected, stats);
+    metrics.addTcpInfo(info);
+    CHECK(metrics.commit() == 0);
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    std::remove(path.c_str());
+    return text.str();
+}
+
+static bool hasLine(const std::string& text, const std::string& line) {
+    return text.find("\n" + line + "\n") != std::string::npos;
+}
+
+// value of an unlabeled sample, NaN if it is missing
+static double sampleValue(const std::string& text, const std::string& name) {
+    size_t pos = text.find("\n" + name + " ");
+    if (pos == std::string::npos) {
+        return std::nan("");
+    }
+    return std::stod(text.substr(pos + name.size() + 2));
+}
+
+int main() {
+    SenderStats stats{};
+    stats.sent = 12345678; // above 1e7, printed as 1.23457e+07 with the default precision
+    stats.syscalls = 9007199254740993ULL; // not representable as a double
+    stats.backlog_bytes = 1234567;
+    TcpInfoSample info{};
+    info.valid = true;
+    info.rtt_us = 1234567;
+    info.delivery_rate = 123456789;
+
+    std::string text = exportText(stats, info);
+    CHECK(hasLine(text, "remote_mndset_frames_sent_total 12345678"));
+    CHECK(hasLine(text, "remote_mndset_send_syscalls_total 9007199254740993"));
+    CHECK(hasLine(text, "remote_mndset_socket_backlog_bytes 1234567"));
+    CHECK(sampleValue(text, "remote_mndset_tcp_rtt_seconds") == 1234567 / 1e6); // round trips exactly
+    CHECK(hasLine(text, "remote_mndset_tcp_delivery_rate_bytes 123456789"));
+    CHECK(text.find("e+") == std::string::npos);
+
+    if (test_failures > 0) {
+        std::cerr << text;
+    }
+    return test_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "movement.h"
+#include "fixed_step.h"
+#include "math_helper.h"
+#include "test_helper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+static bool samePose(const xrt_pose& a, const xrt_pose& b) {
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static xrt_pose startPose(void) {
+    xrt_pose pose{};
+    pose.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
+    pose.position = {0.0f, 1.6f, 0.0f};
+    return pose;
+}
+
+static void pressKey(Movement& movement, SDL_Keycode key) {
+    SDL_Event event{};
+    event.type = SDL_EVENT_KEY_DOWN;
+    event.key.key = key;
+    movement.passKeyboardEvent(event);
+}
+
+/* Poses after every step of a held key, driven at one frame time; mouse_per_ms > 0 adds a steady mouse,
+   each frame passes the counts of its frame time */
+static std::vector<xrt_pose> simulate(uint64_t frame_ns, uint64_t total_ns, float mouse_per_ms = 0.0f) {
+    Movement movement;
+    FixedStep fs;
+    fs.setRate(1000);
+    movement.setFixedStep(fs.getStepNs());
+    pressKey(movement, SDLK_W);
+    pressKey(movement, SDLK_Q);
+    xrt_pose pose = startPose();
+    std::vector<xrt_pose> poses;
+    uint64_t t = 1000000;
+    fs.advance(t);
+    while (t < total_ns) {
+        t += frame_ns;
+        int steps = fs.advance(t);
+        if (mouse_per_ms > 0.0f) {
+            movement.passMouseRelativePos(-mouse_per_ms * static_cast<float>(frame_ns / 1e6), 0.0f);
+        }
+        movement.beginSteps(steps);
+        for (int i = 0; i < steps; i++) {
+            movement.updatePose(pose);
+            poses.push_back(pose);
+        }
+    }
+    return poses;
+}
+
+static float angleBetween(const xrt_quat& a, const xrt_quat& b) {
+    float dot = std::fabs(a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w);
+    return 2.0f * std::acos(std::min(dot, 1.0f));
+}
+
+static void checkFrameRates(void) {
+    std::vector<xrt_pose> reference = simulate(16666667, 1000000000ULL);
+    CHECK(reference.size() > 900);
+    for (uint64_t frame_ns : {33333333ULL, 6944444ULL, 400000ULL}) {
+        std::vector<xrt_pose> poses = simulate(frame_ns, 1000000000ULL);
+        size_t common = std::min(poses.size(), reference.size());
+        CHECK(common > 900);
+        bool same = true;
+        for (size_t i = 0; i < common; i++) {
+            same = same && samePose(poses[i], reference[i]);
+        }
+        CHECK(same); // every step does the same work, whatever the frame rate
+    }
+}
+
+/* The mouse delta of a frame is spread over its steps, at any frame rate the turn keeps within about one step
+   of the 60 Hz run; 2500 fps has frames without a step, their delta must carry over */
+static void checkMouseFrameRates(void) {
+    const float mouse_per_ms = 0.5f;
+    // one step turns mouse_per_ms * mouse_sens * ang_vel * mouse_frame_ms with the default settings
+    const float step_turn = mouse_per_ms * 0.5f * 0.001f * mouse_frame_ms;
+    std::vector<xrt_pose> reference = simulate(16666667, 1000000000ULL, mouse_per_ms);
+    CHECK(reference.size() > 900);
+    CHECK(angleBetween(reference.front().orientation, reference.back().orientation) > 100.0f * step_turn);
+    for (uint64_t frame_ns : {33333333ULL, 6944444ULL, 400000ULL}) {
+        std::vector<xrt_pose> poses = simulate(frame_ns, 1000000000ULL, mouse_per_ms);
+        size_t common = std::min(poses.size(), reference.size());
+        CHECK(common > 900);
+        float worst = 0.0f;
+        for (size_t i = 0; i < common; i++) {
+            worst = std::max(worst, angleBetween(poses[i].orientation, reference[i].orientation));
+        }
+        CHECK(worst < 2.0f * step_turn);
+    }
+}
+
+/* A delta that arrives on a frame without a step turns the pose on the next step */
+static void checkMouseOnZeroStepFrame(void) {
+    Movement late;
+    Movement direct;
+    late.setFixedStep(1000000);
+    direct.setFixedStep(1000000);
+    xrt_pose late_pose = startPose();
+    xrt_pose direct_pose = startPose();
+
+    late.passMouseRelativePos(12.0f, -3.0f);
+    late.beginSteps(0); // no step due, nothing may be lost
+    late.passMouseRelativePos(0.0f, 0.0f);
+    late.beginSteps(2);
+    late.updatePose(late_pose);
+    late.updatePose(late_pose);
+
+    direct.passMouseRelativePos(12.0f, -3.0f);
+    direct.beginSteps(2);
+    direct.updatePose(direct_pose);
+    direct.updatePose(direct_pose);
+
+    auto [late_yaw, late_pitch, late_roll] = quatToYXZ(late_pose.orientation);
+    auto [yaw, pitch, roll] = quatToYXZ(direct_pose.orientation);
+    CHECK(std::fabs(yaw) > 1e-3f && std::fabs(pitch) > 1e-4f);
+    CHECK(std::fabs(late_yaw - yaw) < 1e-6f && std::fabs(late_pitch - pitch) < 1e-6f);
+
+    // the whole delta was used up, further steps do not keep turning
+    late.beginSteps(1);
+    late.updatePose(late_pose);
+    auto [after_yaw, after_pitch, after_roll] = quatToYXZ(late_pose.orientation);
+    CHECK(std::fabs(after_yaw - late_yaw) < 1e-6f && std::fabs(after_pitch - late_pitch) < 1e-6f);
+}
+
+int main() {
+    checkFrameRates();
+    checkMouseFrameRates();
+    checkMouseOnZeroStepFrame();
+    return test_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef TEST_HELPER_H
+#define TEST_HELPER_H
+
+#include <iostream>
+
+static int test_failures = 0;
+
+// records a failed condition with its source line, the test keeps running
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed" << std::endl; \
+            test_failures++; \
+        } \
+    } while (0)
+
+#endif // TEST_HELPER_H
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "data_sender.h"
+#include "wire_protocol.h"
+#include "test_helper.h"
+
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static r_remote_data sampleFrame(void) {
+    r_remote_data data{};
+    data.header = 0; // the serializer writes the header of its version
+    data.head.center.position = {1.0f, 2.0f, 3.0f};
+    data.head.center.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
+    data.left.pose.position.x = 4.0f;
+    data.left.active = true;
+    data.right.trigger_value.x = 0.5f;
+    data.right.a_click = true;
+    return data;
+}
+
+static void checkVersion3(void) {
+    const WireProtocol* v3 = findWireProtocol(3);
+    CHECK(v3 && v3 == defaultWireProtocol());
+    if (!v3) {
+        return;
+    }
+    r_remote_data data = sampleFrame();
+    uint8_t out[max_wire_frame_size];
+    CHECK(v3->serialize(data, out) == sizeof(r_remote_data));
+    data.header = R_HEADER_VALUE;
+    CHECK(memcmp(out, &data, sizeof(data)) == 0);
+}
+
+static void checkVersion2(void) {
+    const WireProtocol* v2 = findWireProtocol(2);
+    CHECK(v2 && v2->frame_size == 280 && !v2->zero_copy);
+    if (!v2) {
+        return;
+    }
+    r_remote_data data = sampleFrame();
+    uint8_t out[max_wire_frame_size];
+    CHECK(v2->serialize(data, out) == 280);
+    CHECK(memcmp(out, "mndrmt2", 8) == 0);
+    CHECK(memcmp(out + 8, &data.head.center, sizeof(xrt_pose)) == 0);
+    CHECK(memcmp(out + 36, &data.left, sizeof(r_remote_controller_data)) == 0);
+    CHECK(memcmp(out + 156, &data.right, sizeof(r_remote_controller_data)) == 0);
+}
+
+/* A downgraded DataSender puts exactly one v2 frame on the socket per sendData() */
+static void checkSendVersion2(void) {
+    std::string path = "/tmp/mndset-wire-test-" + std::to_string(getpid()) + ".sock";
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());
+    CHECK(bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) == 0 && listen(listen_fd, 1) == 0);
+
+    DataSender sender;
+    CHECK(sender.setProtocol(1) < 0);
+    CHECK(sender.setProtocol(2) == 0);
+    sender.openSocket("unix:" + path);
+    for (int i = 0; i < 1000 && sender.updateConnection() == conn_connecting; i++) {
+        usleep(1000);
+    }
+    int fd = accept(listen_fd, nullptr, nullptr);
+    CHECK(sender.isConnected() && fd >= 0);
+    r_remote_data data = sampleFrame();
+    CHECK(sender.sendData(data) == 0);
+    CHECK(sender.sendData(data) == 0);
+    sender.closeSocket();
+
+    uint8_t buf[2 * max_wire_frame_size];
+    size_t got = 0;
+    ssize_t n;
+    while (fd >= 0 && (n = recv(fd, buf + got, sizeof(buf) - got, 0)) > 0) {
+        got += n;
+    }
+    CHECK(got == 2 * 280);
+    CHECK(memcmp(buf, "mndrmt2", 8) == 0 && memcmp(buf + 280, "mndrmt2", 8) == 0);
+    if (fd >= 0) {
+        close(fd);
+    }
+    close(listen_fd);
+    unlink(path.c_str());
+}
+
+int main() {
+    checkVersion3();
+    checkVersion2();
+    checkSendVersion2();
+    return test_failures == 0 ? 0 : 1;
+}
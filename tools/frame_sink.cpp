@@ -0,0 +1,354 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "frame_sink.h"
+#include "transport.h"
+#include "resolver.h"
+#include "tx_timestamps.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const size_t sink_ring_size = 64 * 1024; // a few hundred frames, recv() rarely has to stop early
+static const uint64_t listen_id = 0;
+
+MirrorRing::MirrorRing() {
+    base = nullptr;
+    size = 0;
+    head = 0;
+    tail = 0;
+}
+
+MirrorRing::~MirrorRing() {
+    if (base) {
+        munmap(base, 2 * size);
+    }
+}
+
+int MirrorRing::init(size_t min_size) {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size = (min_size + page - 1) / page * page;
+    int fd = memfd_create("mndset-sink", MFD_CLOEXEC);
+    if (fd < 0 || ftruncate(fd, size) < 0) {
+        perror("memfd");
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return -1;
+    }
+    // reserve both halves first, then map the same pages into each of them
+    void* area = mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (area == MAP_FAILED) {
+        ::close(fd);
+        return -1;
+    }
+    base = static_cast<uint8_t*>(area);
+    if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+        || mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        perror("mmap");
+        ::close(fd);
+        return -1;
+    }
+    ::close(fd); // the mappings keep the memory alive
+    return 0;
+}
+
+uint8_t* MirrorRing::writePtr(void) {
+    return base + (tail % size);
+}
+
+size_t MirrorRing::writable(void) const {
+    return size - (tail - head);
+}
+
+void MirrorRing::commit(size_t n) {
+    tail += n;
+}
+
+const uint8_t* MirrorRing::readPtr(void) const {
+    return base + (head % size);
+}
+
+size_t MirrorRing::readable(void) const {
+    return tail - head;
+}
+
+void MirrorRing::consume(size_t n) {
+    head += n;
+}
+
+FrameSink::FrameSink() {
+    listen_fd = -1;
+    epfd = -1;
+    next_id = listen_id + 1;
+    frames_total = 0;
+    last_rate_ns = monotonicNs();
+}
+
+FrameSink::~FrameSink() {
+    close();
+}
+
+int FrameSink::listen(const std::string& address) {
+    close();
+    TransportAddress parsed;
+    if (parseTransportAddress(address, MONADO_PORT, parsed) < 0 || parsed.kind == transport_shm) {
+        std::cerr << "Cannot listen on " << address << std::endl;
+        return -1;
+    }
+    sockaddr_storage addr{};
+    socklen_t addr_len;
+    if (parsed.kind == transport_unix) {
+        sockaddr_un* un = reinterpret_cast<sockaddr_un*>(&addr);
+        un->sun_family = AF_UNIX;
+        strncpy(un->sun_path, parsed.path.c_str(), sizeof(un->sun_path) - 1);
+        addr_len = sizeof(sockaddr_un);
+        unlink(parsed.path.c_str()); // left over from a sink that was killed
+        unix_path = parsed.path;
+    } else {
+        ResolvedAddress numeric;
+        if (!parseNumericHost(parsed.host, parsed.port, numeric)) {
+            std::cerr << "Listen address must be numeric: " << parsed.host << std::endl;
+            return -1;
+        }
+        addr = numeric.addr;
+        addr_len = numeric.len;
+    }
+    listen_fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    if (listen_fd >= 0 && addr.ss_family != AF_UNIX) {
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)); // restart right after a run
+    }
+    if (listen_fd < 0 || bind(listen_fd, (sockaddr*)&addr, addr_len) < 0 || ::listen(listen_fd, 128) < 0) {
+        perror("sink listen");
+        close();
+        return -1;
+    }
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = listen_id;
+    if (epfd < 0 || epoll_ctl(epfd, EPOLL_CTL_ADD, listen_fd, &ev) < 0) {
+        perror("sink epoll");
+        close();
+        return -1;
+    }
+    return 0;
+}
+
+int FrameSink::getPort(void) {
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (listen_fd < 0 || getsockname(listen_fd, (sockaddr*)&addr, &len) < 0) {
+        return -1;
+    }
+    if (addr.ss_family == AF_INET) {
+        return ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+    }
+    if (addr.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+    }
+    return -1;
+}
+
+void FrameSink::setFrameCallback(FrameCallback frame_callback) {
+    callback = frame_callback;
+}
+
+void FrameSink::acceptClients(void) {
+    while (true) {
+        sockaddr_storage addr{};
+        socklen_t len = sizeof(addr);
+        int fd = accept4(listen_fd, (sockaddr*)&addr, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return; // EAGAIN: all pending connections taken
+        }
+        auto client = std::make_unique<Client>();
+        if (client->ring.init(sink_ring_size) < 0) {
+            ::close(fd);
+            continue;
+        }
+        client->fd = fd;
+        client->last_arrival_ns = 0;
+        client->prev_interval_ns = 0;
+        client->rate_frames = 0;
+        if (addr.ss_family == AF_INET || addr.ss_family == AF_INET6) {
+            client->stats.peer = formatSockaddr({addr, len});
+        } else {
+            client->stats.peer = "unix:" + unix_path + "#" + std::to_string(next_id);
+        }
+        uint64_t id = next_id++;
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = id;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ::close(fd);
+            continue;
+        }
+        std::cout << "Client connected: " << client->stats.peer << std::endl;
+        clients[id] = std::move(client);
+    }
+}
+
+/* Reads until the socket is empty, the ring is drained after every recv so it never fills up */
+void FrameSink::readClient(uint64_t id, Client& client) {
+    while (true) {
+        client.stats.recv_calls++;
+        ssize_t n = recv(client.fd, client.ring.writePtr(), client.ring.writable(), 0);
+        if (n > 0) {
+            client.ring.commit(n);
+            client.stats.bytes += n;
+            parseFrames(id, client, realtimeNs(), monotonicNs());
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+        dropClient(id); // 0: sender closed, or a real error
+        return;
+    }
+}
+
+void FrameSink::parseFrames(uint64_t id, Client& client, uint64_t recv_ns, uint64_t mono_ns) {
+    const uint64_t header = R_HEADER_VALUE;
+    while (client.ring.readable() >= sizeof(r_remote_data)) {
+        const uint8_t* p = client.ring.readPtr();
+        if (memcmp(p, &header, sizeof(header)) != 0) {
+            // lost framing: skip to the next header, keep a tail that could be the start of one
+            client.stats.malformed++;
+            const void* next = memmem(p + 1, client.ring.readable() - 1, &header, sizeof(header));
+            size_t skip = next ? static_cast<const uint8_t*>(next) - p
+                               : client.ring.readable() - (sizeof(header) - 1);
+            client.ring.consume(skip);
+            client.stats.skipped_bytes += skip;
+            continue;
+        }
+        r_remote_data copy;
+        const r_remote_data* frame = reinterpret_cast<const r_remote_data*>(p);
+        if (reinterpret_cast<uintptr_t>(p) % alignof(r_remote_data) != 0) {
+            memcpy(&copy, p, sizeof(copy)); // only after resynchronizing on an odd offset
+            frame = &copy;
+        }
+        client.stats.frames++;
+        frames_total++;
+        if (client.last_arrival_ns != 0) {
+            uint64_t interval = mono_ns - client.last_arrival_ns;
+            client.interarrival.record(interval);
+            if (client.prev_interval_ns != 0) {
+                double d = std::fabs(static_cast<double>(interval) - static_cast<double>(client.prev_interval_ns));
+                client.stats.jitter_us += (d / 1000.0 - client.stats.jitter_us) / 16.0;
+            }
+            client.prev_interval_ns = interval;
+        }
+        client.last_arrival_ns = mono_ns;
+        client.stamps.add(*frame, recv_ns);
+        if (callback) {
+            callback(id, *frame, recv_ns);
+        }
+        client.ring.consume(sizeof(r_remote_data));
+    }
+}
+
+void FrameSink::dropClient(uint64_t id) {
+    auto it = clients.find(id);
+    if (it == clients.end()) {
+        return;
+    }
+    ::close(it->second->fd); // also leaves the epoll set
+    SinkClientStats stats = snapshot(*it->second);
+    stats.connected = false;
+    std::cout << "Client disconnected: " << stats.peer << ", " << stats.frames << " frames, "
+              << stats.malformed << " malformed" << std::endl;
+    closed.push_back(stats);
+    clients.erase(it);
+}
+
+int FrameSink::poll(int timeout_ms) {
+    if (epfd < 0) {
+        return -1;
+    }
+    epoll_event ready[64];
+    int n = epoll_wait(epfd, ready, 64, timeout_ms);
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    uint64_t before = frames_total;
+    for (int i = 0; i < n; i++) {
+        uint64_t id = ready[i].data.u64;
+        if (id == listen_id) {
+            acceptClients();
+            continue;
+        }
+        auto it = clients.find(id);
+        if (it != clients.end()) {
+            readClient(id, *it->second); // also on EPOLLRDHUP, the last data is read before recv returns 0
+        }
+    }
+    return static_cast<int>(frames_total - before);
+}
+
+size_t FrameSink::getClientCount(void) {
+    return clients.size();
+}
+
+SinkClientStats FrameSink::snapshot(const Client& client) const {
+    SinkClientStats stats = client.stats;
+    stats.interarrival = client.interarrival.getSummary();
+    stats.stamped = client.stamps.getReceived() - client.stamps.getUnstamped();
+    stats.lost = client.stamps.getLost();
+    stats.reordered = client.stamps.getReordered();
+    stats.latency = client.stamps.getLatency().getSummary();
+    return stats;
+}
+
+std::vector<SinkClientStats> FrameSink::getClients(bool include_closed) {
+    std::vector<SinkClientStats> result;
+    for (const auto& entry : clients) {
+        result.push_back(snapshot(*entry.second));
+    }
+    if (include_closed) {
+        result.insert(result.end(), closed.begin(), closed.end());
+    }
+    return result;
+}
+
+void FrameSink::takeRates(void) {
+    uint64_t now = monotonicNs();
+    double seconds = (now - last_rate_ns) / 1e9;
+    last_rate_ns = now;
+    for (auto& entry : clients) {
+        Client& client = *entry.second;
+        client.stats.rate_hz = seconds > 0 ? (client.stats.frames - client.rate_frames) / seconds : 0.0;
+        client.rate_frames = client.stats.frames;
+    }
+}
+
+void FrameSink::close(void) {
+    for (auto& entry : clients) {
+        ::close(entry.second->fd);
+    }
+    clients.clear();
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+        listen_fd = -1;
+    }
+    if (epfd >= 0) {
+        ::close(epfd);
+        epfd = -1;
+    }
+    if (!unix_path.empty()) {
+        unlink(unix_path.c_str());
+        unix_path.clear();
+    }
+}
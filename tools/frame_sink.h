@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef FRAME_SINK_H
+#define FRAME_SINK_H
+
+#include "structs.h"
+#include "frame_stamp.h"
+#include "latency_histogram.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* Byte ring mapped twice back to back, so anything readable or writable is one contiguous range:
+   recv() writes straight into it and frames are parsed in place, also across the wrap */
+class MirrorRing {
+    uint8_t* base;
+    size_t size; // page multiple
+    uint64_t head; // read position, both only grow
+    uint64_t tail; // write position
+
+public:
+    MirrorRing();
+    ~MirrorRing();
+    MirrorRing(const MirrorRing&) = delete;
+    MirrorRing& operator=(const MirrorRing&) = delete;
+    int init(size_t min_size); // -1 if the double mapping failed
+    uint8_t* writePtr(void);
+    size_t writable(void) const;
+    void commit(size_t n);
+    const uint8_t* readPtr(void) const;
+    size_t readable(void) const;
+    void consume(size_t n);
+};
+
+// counters of one connected sender
+struct SinkClientStats {
+    std::string peer;
+    bool connected = true;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint64_t malformed = 0; // times the stream had to be resynchronized on the header
+    uint64_t skipped_bytes = 0; // thrown away while resynchronizing
+    uint64_t recv_calls = 0;
+    double rate_hz = 0.0; // frames per second since the previous takeRates() call
+    double jitter_us = 0.0; // RFC 3550 style smoothed change of the inter-arrival time
+    LatencySummary interarrival; // ns recorded, us reported
+    uint64_t stamped = 0; // frames with a frame stamp, see frame_stamp.h
+    uint64_t lost = 0;
+    uint64_t reordered = 0;
+    LatencySummary latency; // one-way from the frame stamps
+};
+
+// Stand-in for monado-service: accepts any number of senders through epoll and checks every frame
+class FrameSink {
+public:
+    // recv_ns: CLOCK_REALTIME when the frame was read, like the frame stamps
+    using FrameCallback = std::function<void(uint64_t client, const r_remote_data& frame, uint64_t recv_ns)>;
+
+private:
+    struct Client {
+        int fd;
+        MirrorRing ring;
+        SinkClientStats stats;
+        uint64_t last_arrival_ns; // CLOCK_MONOTONIC
+        uint64_t prev_interval_ns;
+        uint64_t rate_frames; // frames counted at the last takeRates()
+        LatencyHistogram interarrival;
+        FrameStampTracker stamps;
+    };
+    int listen_fd;
+    int epfd;
+    std::string unix_path; // removed again on close
+    std::unordered_map<uint64_t, std::unique_ptr<Client>> clients;
+    std::vector<SinkClientStats> closed; // kept for the final report
+    uint64_t next_id;
+    uint64_t frames_total;
+    uint64_t last_rate_ns;
+    FrameCallback callback;
+
+    void acceptClients(void);
+    void readClient(uint64_t id, Client& client);
+    void parseFrames(uint64_t id, Client& client, uint64_t recv_ns, uint64_t mono_ns);
+    void dropClient(uint64_t id);
+    SinkClientStats snapshot(const Client& client) const;
+
+public:
+    FrameSink();
+    ~FrameSink();
+    int listen(const std::string& address); // "host[:port]", "[v6]:port" or "unix:/path", -1 on error
+    int getPort(void); // TCP port actually bound, e.g. after asking for port 0
+    void setFrameCallback(FrameCallback frame_callback);
+    int poll(int timeout_ms); // handles ready sockets once, returns frames received or -1
+    size_t getClientCount(void);
+    std::vector<SinkClientStats> getClients(bool include_closed = false);
+    void takeRates(void); // closes the rate_hz window of every client
+    void close(void);
+};
+
+#endif // FRAME_SINK_H
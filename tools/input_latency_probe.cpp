@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "input_latency_probe.h"
+#include "frame_stamp.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+InputLatencyProbe::InputLatencyProbe() {
+    running = false;
+    last_input = 0;
+    matched = 0;
+    unstamped = 0;
+    frames = 0;
+}
+
+InputLatencyProbe::~InputLatencyProbe() {
+    stop();
+}
+
+int InputLatencyProbe::start(void) {
+    if (sink.listen("127.0.0.1:0") < 0) {
+        return -1;
+    }
+    sink.setFrameCallback([this](uint64_t, const r_remote_data& frame, uint64_t recv_ns) {
+        onFrame(frame, recv_ns);
+    });
+    running = true;
+    thread = std::thread([this] {
+        while (running) {
+            sink.poll(50);
+        }
+    });
+    return 0;
+}
+
+void InputLatencyProbe::stop(void) {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    sink.close();
+}
+
+std::string InputLatencyProbe::getAddress(void) {
+    return "127.0.0.1:" + std::to_string(sink.getPort());
+}
+
+void InputLatencyProbe::onFrame(const r_remote_data& frame, uint64_t recv_ns) {
+    std::lock_guard<std::mutex> lock(mutex);
+    frames++;
+    uint32_t input = readFrameInput(frame);
+    if (input == 0 || input == last_input) {
+        return; // no input yet, or a later frame of the same input
+    }
+    last_input = input;
+    FrameStamp stamp;
+    if (!readFrameStamp(frame, recv_ns, stamp)) {
+        unstamped++;
+        return;
+    }
+    latency.record(recv_ns >= stamp.send_ns ? recv_ns - stamp.send_ns : 0);
+    matched++;
+}
+
+LatencySummary InputLatencyProbe::getSummary(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return latency.getSummary();
+}
+
+int InputLatencyProbe::writeReport(const std::string& path, uint64_t inputs, int send_rate) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return -1;
+    }
+    auto us = [](uint64_t ns) { return ns / 1000.0; };
+    out << "{\n";
+    out << "  \"benchmark\": \"input_to_receive\",\n";
+    out << "  \"unit\": \"us\",\n";
+    out << "  \"send_rate_hz\": " << send_rate << ",\n";
+    out << "  \"inputs\": " << inputs << ",\n";
+    out << "  \"matched\": " << matched << ",\n";
+    out << "  \"missed\": " << (inputs > matched ? inputs - matched : 0) << ",\n"; // replaced before being sent
+    out << "  \"unstamped\": " << unstamped << ",\n";
+    out << "  \"frames\": " << frames << ",\n";
+    out << "  \"min\": " << us(latency.getMin()) << ",\n";
+    out << "  \"mean\": " << latency.getMean() / 1000.0 << ",\n";
+    out << "  \"p50\": " << us(latency.getPercentile(50.0)) << ",\n";
+    out << "  \"p90\": " << us(latency.getPercentile(90.0)) << ",\n";
+    out << "  \"p99\": " << us(latency.getPercentile(99.0)) << ",\n";
+    out << "  \"p99.9\": " << us(latency.getPercentile(99.9)) << ",\n";
+    out << "  \"max\": " << us(latency.getMax()) << ",\n";
+    out << "  \"buckets\": [";
+    auto buckets = latency.getBuckets();
+    for (size_t i = 0; i < buckets.size(); i++) {
+        out << (i ? ", " : "") << "[" << us(buckets[i].first) << ", " << buckets[i].second << "]";
+    }
+    out << "]\n";
+    out << "}\n";
+    return out ? 0 : -1;
+}
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef INPUT_LATENCY_PROBE_H
+#define INPUT_LATENCY_PROBE_H
+
+#include "frame_sink.h"
+#include "latency_histogram.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/* Loopback receiver of the input latency benchmark: the first frame carrying a new input id
+   (see writeFrameInput) is matched, its frame stamp holds the time of the input event */
+class InputLatencyProbe {
+    FrameSink sink;
+    std::thread thread;
+    std::atomic<bool> running;
+    std::mutex mutex;
+    LatencyHistogram latency; // ns, guarded by mutex
+    uint32_t last_input; // guarded by mutex
+    uint64_t matched;
+    uint64_t unstamped; // frames with an input id but without a frame stamp
+    uint64_t frames;
+
+    void onFrame(const r_remote_data& frame, uint64_t recv_ns);
+public:
+    InputLatencyProbe();
+    ~InputLatencyProbe();
+    int start(void); // listens on a free loopback port, -1 on error
+    void stop(void);
+    std::string getAddress(void); // to connect the sender to
+    LatencySummary getSummary(void);
+    // machine-readable report, inputs is how many were generated so the misses can be counted
+    int writeReport(const std::string& path, uint64_t inputs, int send_rate);
+};
+
+#endif // INPUT_LATENCY_PROBE_H
@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "jitter_bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+static const size_t io_chunk = 256 * 1024;
+static const off_t io_file_size = 64 * 1024 * 1024; // rewritten from the start, the disk use stays bounded
+
+JitterBench::JitterBench() {
+    stressing = false;
+    io_bytes = 0;
+}
+
+JitterBench::~JitterBench() {
+    stopStress();
+}
+
+void JitterBench::reserve(int seconds, int send_rate) {
+    loop.reserve(static_cast<size_t>(seconds) * 1000); // vsync rarely goes above that
+    send.reserve(static_cast<size_t>(seconds) * send_rate + 1000);
+}
+
+int JitterBench::startStress(const StressOptions& options) {
+    stopStress();
+    stress = options;
+    if (stress.io_threads > 0 && access(stress.io_dir.c_str(), W_OK) < 0) {
+        std::cerr << "Cannot write IO stress files to " << stress.io_dir << std::endl;
+        return -1;
+    }
+    stressing = true;
+    for (int i = 0; i < stress.cpu_threads; i++) {
+        threads.emplace_back(&JitterBench::cpuStress, this);
+    }
+    for (int i = 0; i < stress.io_threads; i++) {
+        threads.emplace_back(&JitterBench::ioStress, this, i);
+    }
+    return 0;
+}
+
+void JitterBench::stopStress(void) {
+    stressing = false;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+}
+
+void JitterBench::cpuStress(void) {
+    volatile double sink = 0.0;
+    double x = 1.0;
+    while (stressing) {
+        for (int i = 0; i < 10000; i++) {
+            x = std::sqrt(x + i) * 1.0000001;
+        }
+        sink = x;
+    }
+    (void)sink;
+}
+
+void JitterBench::ioStress(int index) {
+    std::string path = stress.io_dir + "/mndset-stress-" + std::to_string(getpid()) + "-" + std::to_string(index);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        perror("IO stress");
+        return;
+    }
+    unlink(path.c_str()); // gone even if the benchmark is killed
+    std::vector<char> chunk(io_chunk, static_cast<char>(index));
+    off_t offset = 0;
+    while (stressing) {
+        if (pwrite(fd, chunk.data(), chunk.size(), offset) < 0 || fdatasync(fd) < 0) {
+            perror("IO stress");
+            break;
+        }
+        io_bytes += chunk.size();
+        offset = (offset + static_cast<off_t>(chunk.size())) % io_file_size;
+    }
+    close(fd);
+}
+
+PeriodRecorder& JitterBench::getLoop(void) {
+    return loop;
+}
+
+PeriodRecorder& JitterBench::getSend(void) {
+    return send;
+}
+
+void JitterBench::printSummary(int send_rate) {
+    auto print = [](const char* name, const PeriodSummary& s) {
+        printf("%s: %llu periods, nominal %.1f us, mean %.1f us, stddev %.1f us, deviation p50 %.1f p99 %.1f "
+               "p99.9 %.1f max %.1f us\n", name, (unsigned long long)s.count, s.nominal_us, s.mean_us, s.stddev_us,
+               s.dev_p50_us, s.dev_p99_us, s.dev_p999_us, s.dev_max_us);
+    };
+    print("Loop", loop.getSummary());
+    print("Send", send.getSummary(1000000000ULL / std::max(send_rate, 1)));
+    if (io_bytes > 0) {
+        printf("IO stress wrote %.1f MiB\n", io_bytes / (1024.0 * 1024.0));
+    }
+}
+
+int JitterBench::writeReport(const std::string& path, int send_rate, const std::string& present_mode) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return -1;
+    }
+    auto section = [&out](const char* name, const PeriodRecorder& recorder, uint64_t nominal_ns, uint64_t bucket_ns) {
+        PeriodSummary s = recorder.getSummary(nominal_ns);
+        out << "  \"" << name << "\": {\n";
+        out << "    \"periods\": " << s.count << ",\n";
+        out << "    \"nominal\": " << s.nominal_us << ",\n";
+        out << "    \"mean\": " << s.mean_us << ",\n";
+        out << "    \"stddev\": " << s.stddev_us << ",\n";
+        out << "    \"min\": " << s.min_us << ",\n";
+        out << "    \"max\": " << s.max_us << ",\n";
+        out << "    \"deviation_p50\": " << s.dev_p50_us << ",\n";
+        out << "    \"deviation_p99\": " << s.dev_p99_us << ",\n";
+        out << "    \"deviation_p99.9\": " << s.dev_p999_us << ",\n";
+        out << "    \"deviation_max\": " << s.dev_max_us << ",\n";
+        out << "    \"bucket_width\": " << bucket_ns / 1000.0 << ",\n";
+        out << "    \"histogram\": [";
+        auto buckets = recorder.getHistogram(bucket_ns);
+        for (size_t i = 0; i < buckets.size(); i++) {
+            out << (i ? ", " : "") << "[" << buckets[i].first / 1000.0 << ", " << buckets[i].second << "]";
+        }
+        out << "]\n  }";
+    };
+    uint64_t send_ns = 1000000000ULL / std::max(send_rate, 1);
+    out << "{\n";
+    out << "  \"benchmark\": \"loop_jitter\",\n";
+    out << "  \"unit\": \"us\",\n";
+    out << "  \"present_mode\": \"" << present_mode << "\",\n";
+    out << "  \"send_rate_hz\": " << send_rate << ",\n";
+    out << "  \"cpu_stress_threads\": " << stress.cpu_threads << ",\n";
+    out << "  \"io_stress_threads\": " << stress.io_threads << ",\n";
+    out << "  \"io_stress_bytes\": " << io_bytes << ",\n";
+    // 1/20 of the nominal period per bucket, fine enough to see a bimodal distribution
+    section("loop", loop, 0, std::max<uint64_t>(loop.getMedian() / 20, 1000));
+    out << ",\n";
+    section("send", send, send_ns, std::max<uint64_t>(send_ns / 20, 1000));
+    out << "\n}\n";
+    return out ? 0 : -1;
+}
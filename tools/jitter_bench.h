@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef JITTER_BENCH_H
+#define JITTER_BENCH_H
+
+#include "period_recorder.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct StressOptions {
+    int cpu_threads = 0; // busy loops on floating point math
+    int io_threads = 0; // buffered writes with fdatasync() to a file in io_dir
+    std::string io_dir = "/tmp";
+};
+
+/* Main loop and send period jitter benchmark: the render loop marks getLoop() once per iteration,
+   the sender thread marks getSend() after every frame, optional stress threads compete for the CPU and disk */
+class JitterBench {
+    PeriodRecorder loop;
+    PeriodRecorder send;
+    StressOptions stress;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stressing;
+    std::atomic<uint64_t> io_bytes;
+
+    void cpuStress(void);
+    void ioStress(int index);
+public:
+    JitterBench();
+    ~JitterBench();
+    void reserve(int seconds, int send_rate);
+    int startStress(const StressOptions& options); // -1 if the IO directory is not writable
+    void stopStress(void);
+    PeriodRecorder& getLoop(void);
+    PeriodRecorder& getSend(void);
+    void printSummary(int send_rate);
+    // send_rate gives the nominal send period, the loop is measured against its median (vsync rate is not known)
+    int writeReport(const std::string& path, int send_rate, const std::string& present_mode);
+};
+
+#endif // JITTER_BENCH_H
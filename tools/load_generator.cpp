@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "load_generator.h"
+#include "data_sender.h"
+#include "frame_stamp.h"
+#include "latency_histogram.h"
+#include "math_helper.h"
+#include "movement.h"
+#include "tx_timestamps.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <random>
+
+static void pressKey(Movement& movement, SDL_Keycode key, bool down) {
+    SDL_Event event{};
+    event.type = down ? SDL_EVENT_KEY_DOWN : SDL_EVENT_KEY_UP;
+    event.key.key = key;
+    event.key.down = down;
+    movement.passKeyboardEvent(event);
+}
+
+// one remote-mndset instance without the window: the same poses main.cpp computes, from procedural input
+struct LoadGenerator::VirtualUser {
+    int index;
+    DataSender sender;
+    Movement hmd;
+    Movement left;
+    Movement right;
+    r_remote_data data{};
+    r_remote_data old_data{};
+    xrt_pose left_rel;
+    xrt_pose right_rel;
+    std::mt19937 rng;
+    uint64_t next_change_ms; // when the held keys change
+    SDL_Keycode keys[2]; // walk and strafe key held right now, 0 for none
+    float phase; // of the mouse motion, so users do not move in lockstep
+    bool was_connected;
+    LatencyHistogram send_call; // ns
+
+    VirtualUser(int user_index);
+    void drive(uint64_t now_ns);
+};
+
+LoadGenerator::VirtualUser::VirtualUser(int user_index) : rng(static_cast<unsigned>(user_index) + 1) {
+    index = user_index;
+    const xrt_quat default_quat = {0.0f, 0.0f, 0.0f, 1.0f};
+    data.header = R_HEADER_VALUE;
+    data.head.center.orientation = default_quat;
+    data.head.center.position = {0.0f, 1.7f, 1.0f};
+    data.left.pose.orientation = default_quat;
+    data.right.pose.orientation = default_quat;
+    data.left.active = true;
+    data.right.active = true;
+    left_rel = {default_quat, {-0.3f, -0.3f, -0.4f}};
+    right_rel = {default_quat, {0.3f, -0.3f, -0.4f}};
+    writeFrameInput(data, static_cast<uint32_t>(user_index) + 1); // the receiver can tell the users apart
+    old_data = data;
+    next_change_ms = 0;
+    keys[0] = 0;
+    keys[1] = 0;
+    phase = std::uniform_real_distribution<float>(0.0f, 6.2832f)(rng);
+    was_connected = false;
+    // defaults of the GUI settings
+    hmd.updateConfigValues(1.0f, 1.0f, 0.5f, 1.0f, 0.1f);
+    left.updateConfigValues(1.0f, 1.0f, 0.5f, 1.0f, 0.1f);
+    right.updateConfigValues(1.0f, 1.0f, 0.5f, 1.0f, 0.1f);
+}
+
+/* Walk and strafe keys held for 0.5..3 s at random, the mouse follows slow sine waves */
+void LoadGenerator::VirtualUser::drive(uint64_t now_ns) {
+    uint64_t now_ms = now_ns / 1000000;
+    if (now_ms >= next_change_ms) {
+        static const SDL_Keycode walk_keys[] = {0, SDLK_W, SDLK_S};
+        static const SDL_Keycode strafe_keys[] = {0, 0, SDLK_A, SDLK_D};
+        for (SDL_Keycode key : keys) {
+            if (key != 0) {
+                pressKey(hmd, key, false);
+            }
+        }
+        keys[0] = walk_keys[rng() % 3];
+        keys[1] = strafe_keys[rng() % 4];
+        for (SDL_Keycode key : keys) {
+            if (key != 0) {
+                pressKey(hmd, key, true);
+            }
+        }
+        next_change_ms = now_ms + 500 + rng() % 2500;
+    }
+    double t = now_ns / 1e9 + phase; // a float would lose the fraction of the monotonic seconds
+    hmd.passMouseRelativePos(2.0f * std::sin(0.3 * t), 0.5f * std::sin(0.7 * t));
+    left.passMouseRelativePos(std::sin(1.1 * t), std::cos(0.9 * t));
+    right.passMouseRelativePos(std::cos(1.3 * t), std::sin(0.8 * t));
+    data.left.trigger_value = xrt_vec1{static_cast<float>(0.5 + 0.5 * std::sin(2.0 * t))};
+    data.left.trigger_click = data.left.trigger_value.x > gamepad_click_threshold;
+
+    hmd.updateTicks(now_ns);
+    left.updateTicks(now_ns);
+    right.updateTicks(now_ns);
+    hmd.updatePose(data.head.center);
+    left.updatePose(left_rel);
+    data.left.pose = poseMult(data.head.center, left_rel);
+    left.updateVelocity(data.left.pose, old_data.left.pose, data.left.linear_velocity, data.left.angular_velocity);
+    right.updatePose(right_rel);
+    data.right.pose = poseMult(data.head.center, right_rel);
+    right.updateVelocity(data.right.pose, old_data.right.pose, data.right.linear_velocity,
+                         data.right.angular_velocity);
+    old_data = data;
+}
+
+LoadGenerator::LoadGenerator() {
+    running = false;
+    sent_total = 0;
+    unsent_total = 0;
+    connected = 0;
+}
+
+LoadGenerator::~LoadGenerator() {
+    stop();
+    users.clear(); // closes the connections
+}
+
+int LoadGenerator::start(const LoadOptions& load) {
+    if (running || load.clients <= 0 || load.threads <= 0 || load.rate_hz <= 0) {
+        return -1;
+    }
+    options = load;
+    options.threads = std::min(options.threads, options.clients);
+    users.clear();
+    for (int i = 0; i < options.clients; i++) {
+        auto user = std::make_unique<VirtualUser>(i);
+        user->sender.setSendMode(options.send_mode, options.max_backlog_frames);
+        user->sender.setBackend(options.backend, false);
+        user->sender.setTxTimestamps(options.tx_timestamps);
+        user->sender.setFrameStamps(options.frame_stamps);
+        if (user->sender.openSocket(options.address) < 0) {
+            users.clear();
+            return -1;
+        }
+        users.push_back(std::move(user));
+    }
+    sent_total = 0;
+    unsent_total = 0;
+    connected = 0;
+    running = true;
+    for (int t = 0; t < options.threads; t++) {
+        workers.emplace_back(&LoadGenerator::worker, this, t);
+    }
+    return 0;
+}
+
+void LoadGenerator::stop(void) {
+    running = false;
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    workers.clear(); // connections stay open until the next start(), getReports() shows their state
+}
+
+/* Users index, index + threads, ... share one thread; every tick each of them computes and sends a frame */
+void LoadGenerator::worker(int index) {
+    std::vector<VirtualUser*> mine;
+    for (size_t i = index; i < users.size(); i += options.threads) {
+        mine.push_back(users[i].get());
+    }
+    timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    // spread the threads over the period, the receiver does not get all users at the same instant
+    long period_ns = 1000000000L / options.rate_hz;
+    next.tv_nsec += period_ns * index / options.threads;
+    while (running) {
+        uint64_t now_ns = monotonicNs(); // shared by the users of this tick like SDL_GetTicksNS() in main.cpp
+        uint64_t sent = 0;
+        uint64_t unsent = 0;
+        for (VirtualUser* user : mine) {
+            bool is_connected = user->sender.updateConnection() == conn_connected;
+            if (is_connected != user->was_connected) {
+                connected += is_connected ? 1 : -1;
+                user->was_connected = is_connected;
+            }
+            user->drive(now_ns);
+            if (is_connected) {
+                uint64_t t0 = monotonicNs();
+                int res = user->sender.sendData(user->data);
+                user->send_call.record(monotonicNs() - t0);
+                user->sender.collectTimestamps();
+                if (res >= 0) {
+                    sent++;
+                } else {
+                    unsent++;
+                }
+            }
+        }
+        sent_total += sent;
+        unsent_total += unsent;
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec > next.tv_sec || (now.tv_sec == next.tv_sec && now.tv_nsec > next.tv_nsec)) {
+            next = now; // overloaded, do not try to catch up with a burst
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+    }
+}
+
+uint64_t LoadGenerator::getSent(void) {
+    return sent_total;
+}
+
+uint64_t LoadGenerator::getUnsent(void) {
+    return unsent_total;
+}
+
+int LoadGenerator::getConnected(void) {
+    return connected;
+}
+
+std::vector<VirtualUserReport> LoadGenerator::getReports(void) {
+    std::vector<VirtualUserReport> reports;
+    for (auto& user : users) {
+        VirtualUserReport report;
+        report.index = user->index;
+        report.state = user->sender.getState();
+        report.stats = user->sender.getStats();
+        report.send_call = user->send_call.getSummary();
+        report.send_call_p999_us = user->send_call.getPercentile(99.9) / 1000.0;
+        report.tx_latency = user->sender.getTxLatency();
+        reports.push_back(report);
+    }
+    return reports;
+}
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include "structs.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct LoadOptions {
+    std::string address; // like the GUI's server address
+    int clients = 50;
+    int threads = 4; // every thread sends for clients / threads virtual users
+    int rate_hz = 250; // per client
+    SendMode send_mode = send_latest;
+    int max_backlog_frames = 2;
+    TransportBackend backend = backend_socket;
+    bool tx_timestamps = false;
+    bool frame_stamps = true; // the receiver measures one-way latency and loss from them
+};
+
+// what one virtual user saw, read after LoadGenerator::stop()
+struct VirtualUserReport {
+    int index = 0;
+    ConnectionState state = conn_disconnected;
+    SenderStats stats;
+    LatencySummary send_call; // time inside DataSender::sendData()
+    double send_call_p999_us = 0.0;
+    TxLatencyStats tx_latency; // enabled with LoadOptions::tx_timestamps
+};
+
+/* Many remote-mndset clients in one process: each virtual user has its own HMD and controller
+   Movement objects driven by procedural input and its own DataSender, a few threads share the sending */
+class LoadGenerator {
+    struct VirtualUser;
+    std::vector<std::unique_ptr<VirtualUser>> users;
+    std::vector<std::thread> workers;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> sent_total; // frames sendData() wrote out
+    std::atomic<uint64_t> unsent_total; // held back by the backlog bound (dropped or coalesced later) or failed
+    std::atomic<int> connected;
+    LoadOptions options;
+
+    void worker(int index);
+public:
+    LoadGenerator();
+    ~LoadGenerator();
+    int start(const LoadOptions& load); // -1 if the options make no sense
+    void stop(void);
+    uint64_t getSent(void);
+    uint64_t getUnsent(void);
+    int getConnected(void);
+    std::vector<VirtualUserReport> getReports(void); // only after stop()
+};
+
+#endif // LOAD_GENERATOR_H
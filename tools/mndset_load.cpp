@@ -0,0 +1,246 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+// mndset-load: many virtual remote-mndset users against monado-service, mndset-sink or an in-process sink
+
+#include "frame_sink.h"
+#include "frame_stamp.h"
+#include "load_generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void onSignal(int) {
+    stop_requested = 1;
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [address] [-c clients] [-t threads] [-r rate_hz] [-d seconds] [-q] [-b socket|uring]\n"
+           "       [--tx-timestamps] [--sink] [--json path]\n", name);
+    printf("  address          host[:port], [v6]:port or unix:/path, default 127.0.0.1:%d\n", MONADO_PORT);
+    printf("  -c               virtual users, default 50\n");
+    printf("  -t               sending threads, default 4\n");
+    printf("  -r               frames per second of every user, default 250\n");
+    printf("  -d               duration, default 10 s, 0 runs until Ctrl+C\n");
+    printf("  -q               send_queue mode instead of send_latest\n");
+    printf("  --tx-timestamps  kernel TX timestamps per user\n");
+    printf("  --sink           receive in-process on loopback and measure one-way latency per user\n");
+}
+
+// worst, median and best of one per-user value
+static void spread(std::vector<double> values, double& best, double& median, double& worst) {
+    best = median = worst = 0.0;
+    if (!values.empty()) {
+        std::sort(values.begin(), values.end());
+        best = values.front();
+        median = values[values.size() / 2];
+        worst = values.back();
+    }
+}
+
+int main(int argc, char** argv) {
+    LoadOptions options;
+    options.address = "127.0.0.1:" + std::to_string(MONADO_PORT);
+    int duration_s = 10;
+    bool use_sink = false;
+    std::string json;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            options.clients = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            options.rate_hz = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            duration_s = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-q") == 0) {
+            options.send_mode = send_queue;
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            options.backend = strcmp(argv[++i], "uring") == 0 ? backend_uring : backend_socket;
+        } else if (strcmp(argv[i], "--tx-timestamps") == 0) {
+            options.tx_timestamps = true;
+        } else if (strcmp(argv[i], "--sink") == 0) {
+            use_sink = true;
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            options.address = argv[i];
+        }
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    // every user writes its index + 1 into the input id of its frames, see LoadGenerator::VirtualUser
+    FrameSink sink;
+    std::vector<FrameStampTracker> trackers(std::max(options.clients, 0));
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool> sink_running{false};
+    std::thread receiver;
+    if (use_sink) {
+        if (sink.listen("127.0.0.1:0") < 0) {
+            return 1;
+        }
+        sink.setFrameCallback([&](uint64_t, const r_remote_data& frame, uint64_t recv_ns) {
+            uint32_t user = readFrameInput(frame);
+            if (user >= 1 && user <= trackers.size()) {
+                trackers[user - 1].add(frame, recv_ns); // only the receiver thread touches the trackers
+            }
+            received++;
+        });
+        options.address = "127.0.0.1:" + std::to_string(sink.getPort());
+        sink_running = true;
+        receiver = std::thread([&] {
+            while (sink_running) {
+                sink.poll(50);
+            }
+        });
+    }
+
+    LoadGenerator load;
+    if (load.start(options) < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    printf("%d users at %d Hz on %d threads to %s\n", options.clients, options.rate_hz,
+           std::min(options.threads, options.clients), options.address.c_str());
+
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    auto next_report = start + std::chrono::seconds(1);
+    uint64_t last_sent = 0;
+    uint64_t last_unsent = 0;
+    uint64_t last_received = 0;
+    while (!stop_requested && (duration_s == 0 || clock::now() - start < std::chrono::seconds(duration_s))) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (clock::now() >= next_report) {
+            uint64_t sent = load.getSent();
+            uint64_t unsent = load.getUnsent();
+            printf("connected %d/%d, sent %llu frames/s, not sent %llu/s", load.getConnected(), options.clients,
+                   (unsigned long long)(sent - last_sent), (unsigned long long)(unsent - last_unsent));
+            if (use_sink) {
+                printf(", received %llu frames/s", (unsigned long long)(received - last_received));
+            }
+            printf("\n");
+            fflush(stdout);
+            last_sent = sent;
+            last_unsent = unsent;
+            last_received = received;
+            next_report += std::chrono::seconds(1);
+        }
+    }
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    load.stop();
+    if (use_sink) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100)); // let the sink drain the sockets
+        sink_running = false;
+        receiver.join();
+    }
+
+    std::vector<VirtualUserReport> reports = load.getReports();
+    std::vector<double> call_p99, tx_p99, one_way_p99, rates;
+    uint64_t sent_total = 0;
+    uint64_t dropped_total = 0;
+    printf("%6s %10s %9s %9s %10s %10s %10s", "user", "sent", "dropped", "frames/s", "call p50us", "call p99us",
+           "call maxus");
+    if (options.tx_timestamps) {
+        printf(" %10s", "tx p99us");
+    }
+    if (use_sink) {
+        printf(" %8s %10s %10s %10s", "lost", "rx p50us", "rx p99us", "rx maxus");
+    }
+    printf("\n");
+    for (const auto& r : reports) {
+        sent_total += r.stats.sent;
+        dropped_total += r.stats.dropped;
+        rates.push_back(r.stats.sent / elapsed);
+        call_p99.push_back(r.send_call.p99_us);
+        printf("%6d %10llu %9llu %9.1f %10.1f %10.1f %10.1f", r.index + 1, (unsigned long long)r.stats.sent,
+               (unsigned long long)r.stats.dropped, r.stats.sent / elapsed, r.send_call.p50_us, r.send_call.p99_us,
+               r.send_call.max_us);
+        if (options.tx_timestamps) {
+            tx_p99.push_back(r.tx_latency.total.p99_us);
+            printf(" %10.1f", r.tx_latency.total.p99_us);
+        }
+        if (use_sink) {
+            const FrameStampTracker& t = trackers[r.index];
+            LatencySummary l = t.getLatency().getSummary();
+            one_way_p99.push_back(l.p99_us);
+            printf(" %8llu %10.1f %10.1f %10.1f", (unsigned long long)t.getLost(), l.p50_us, l.p99_us, l.max_us);
+        }
+        printf("\n");
+    }
+    double best, median, worst;
+    printf("Aggregate: %.0f frames/s sent, %llu dropped", sent_total / elapsed, (unsigned long long)dropped_total);
+    if (use_sink) {
+        printf(", %.0f frames/s received", received / elapsed);
+    }
+    printf("\n");
+    spread(rates, best, median, worst);
+    printf("Per user frames/s: min %.1f, median %.1f, max %.1f\n", best, median, worst);
+    spread(call_p99, best, median, worst);
+    printf("Per user sendData() p99: min %.1f, median %.1f, max %.1f us\n", best, median, worst);
+    if (!tx_p99.empty()) {
+        spread(tx_p99, best, median, worst);
+        printf("Per user TX total p99: min %.1f, median %.1f, max %.1f us\n", best, median, worst);
+    }
+    if (!one_way_p99.empty()) {
+        spread(one_way_p99, best, median, worst);
+        printf("Per user one-way p99: min %.1f, median %.1f, max %.1f us\n", best, median, worst);
+    }
+
+    if (!json.empty()) {
+        std::ofstream out(json);
+        if (!out) {
+            std::cerr << "Cannot write " << json << std::endl;
+            return 1;
+        }
+        out << "{\n  \"benchmark\": \"load\",\n  \"unit\": \"us\",\n";
+        out << "  \"users\": " << options.clients << ",\n  \"threads\": " << options.threads << ",\n";
+        out << "  \"rate_hz\": " << options.rate_hz << ",\n  \"seconds\": " << elapsed << ",\n";
+        out << "  \"sent_per_s\": " << sent_total / elapsed << ",\n";
+        if (use_sink) {
+            out << "  \"received_per_s\": " << received / elapsed << ",\n";
+        }
+        out << "  \"clients\": [\n";
+        for (size_t i = 0; i < reports.size(); i++) {
+            const VirtualUserReport& r = reports[i];
+            out << "    {\"user\": " << r.index + 1 << ", \"sent\": " << r.stats.sent << ", \"dropped\": "
+                << r.stats.dropped << ", \"call_p50\": " << r.send_call.p50_us << ", \"call_p99\": "
+                << r.send_call.p99_us << ", \"call_p99.9\": " << r.send_call_p999_us << ", \"call_max\": "
+                << r.send_call.max_us;
+            if (options.tx_timestamps) {
+                out << ", \"tx_p50\": " << r.tx_latency.total.p50_us << ", \"tx_p99\": " << r.tx_latency.total.p99_us;
+            }
+            if (use_sink) {
+                const FrameStampTracker& t = trackers[r.index];
+                const LatencyHistogram& l = t.getLatency();
+                out << ", \"lost\": " << t.getLost() << ", \"rx_p50\": " << l.getPercentile(50.0) / 1000.0
+                    << ", \"rx_p99\": " << l.getPercentile(99.0) / 1000.0 << ", \"rx_p99.9\": "
+                    << l.getPercentile(99.9) / 1000.0 << ", \"rx_max\": " << l.getMax() / 1000.0;
+            }
+            out << "}" << (i + 1 < reports.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        if (!out) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+// mndset-sink: receives remote-mndset streams like monado-service would and reports what arrived
+
+#include "frame_sink.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void onSignal(int) {
+    stop_requested = 1;
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [address] [-i report_interval_ms] [-n seconds]\n", name);
+    printf("  address  host[:port], [v6]:port or unix:/path, default 0.0.0.0:%d\n", MONADO_PORT);
+    printf("  -i       statistics interval, default 1000 ms, 0 prints only the summary\n");
+    printf("  -n       exit after this many seconds, default: until Ctrl+C\n");
+}
+
+static void printTable(const std::vector<SinkClientStats>& clients, bool summary) {
+    printf("%-28s %10s %9s %9s %10s %10s %9s %8s %10s %10s\n", "client", "frames", summary ? "" : "frames/s",
+           "malformed", "gap p50us", "gap p99us", "jitterus", "lost", "lat p50us", "lat p99us");
+    for (const auto& c : clients) {
+        printf("%-28s %10llu ", c.peer.c_str(), (unsigned long long)c.frames);
+        if (summary) {
+            printf("%9s", c.connected ? "" : "closed");
+        } else {
+            printf("%9.1f", c.rate_hz);
+        }
+        printf(" %9llu %10.1f %10.1f %9.1f", (unsigned long long)c.malformed, c.interarrival.p50_us,
+               c.interarrival.p99_us, c.jitter_us);
+        if (c.stamped > 0) {
+            printf(" %8llu %10.1f %10.1f\n", (unsigned long long)c.lost, c.latency.p50_us, c.latency.p99_us);
+        } else {
+            printf(" %8s %10s %10s\n", "-", "-", "-"); // sender runs without frame stamps
+        }
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    std::string address = "0.0.0.0:" + std::to_string(MONADO_PORT);
+    int interval_ms = 1000;
+    int duration_s = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            interval_ms = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            duration_s = std::atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            address = argv[i];
+        }
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    FrameSink sink;
+    if (sink.listen(address) < 0) {
+        return 1;
+    }
+    printf("Listening on %s", address.c_str());
+    if (sink.getPort() > 0) {
+        printf(" (port %d)", sink.getPort()); // useful when asked for port 0
+    }
+    printf("\n");
+    using clock = std::chrono::steady_clock;
+    auto next_report = clock::now() + std::chrono::milliseconds(interval_ms);
+    auto end = clock::now() + std::chrono::seconds(duration_s);
+    while (!stop_requested && (duration_s == 0 || clock::now() < end)) {
+        if (sink.poll(100) < 0) {
+            perror("epoll_wait");
+            break;
+        }
+        if (interval_ms > 0 && clock::now() >= next_report) {
+            next_report += std::chrono::milliseconds(interval_ms);
+            sink.takeRates();
+            auto clients = sink.getClients();
+            if (!clients.empty()) {
+                printTable(clients, false);
+            }
+        }
+    }
+    printf("-- summary\n");
+    printTable(sink.getClients(true), true);
+    return 0;
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "transport.h"
+
+#include <algorithm>
+#include <sys/un.h>
+
+static bool hasPrefix(const std::string& s, const char* prefix, std::string& rest) {
+    std::string p(prefix);
+    if (s.compare(0, p.size(), p) != 0) {
+        return false;
+    }
+    rest = s.substr(p.size());
+    return true;
+}
+
+int parseTransportAddress(const std::string& address, int default_port, TransportAddress& result) {
+    result = TransportAddress{};
+    std::string rest;
+    if (hasPrefix(address, "unix:", rest)) {
+        if (rest.empty() || rest.size() >= sizeof(sockaddr_un::sun_path)) {
+            return -1;
+        }
+        result.kind = transport_unix;
+        result.path = rest;
+        return 0;
+    }
+    if (hasPrefix(address, "shm:", rest)) {
+        if (rest.empty() || rest.find('/', 1) != std::string::npos) {
+            return -1; // POSIX shm names are a single component
+        }
+        result.kind = transport_shm;
+        result.path = rest[0] == '/' ? rest : "/" + rest;
+        return 0;
+    }
+    result.kind = transport_tcp;
+    result.host = address;
+    result.port = default_port;
+    std::string port;
+    if (!address.empty() && address[0] == '[') {
+        // [v6]:port, the brackets keep the port apart from the address
+        size_t close = address.find(']');
+        if (close == std::string::npos || (close + 1 < address.size() && address[close + 1] != ':')) {
+            return -1;
+        }
+        result.host = address.substr(1, close - 1);
+        port = close + 1 < address.size() ? address.substr(close + 2) : "";
+    } else if (std::count(address.begin(), address.end(), ':') == 1) {
+        size_t colon = address.find(':');
+        result.host = address.substr(0, colon);
+        port = address.substr(colon + 1);
+    } // more colons: a bare IPv6 literal on the default port
+    if (!port.empty()) {
+        try {
+            result.port = std::stoi(port);
+        } catch (const std::exception&) {
+            return -1;
+        }
+    }
+    if (result.host.empty() || result.port < 0 || result.port > 65535) { // 0: any free port when listening
+        return -1;
+    }
+    return 0;
+}
+
+std::string formatTransportAddress(const TransportAddress& address) {
+    switch (address.kind) {
+    case transport_unix:
+        return "unix:" + address.path;
+    case transport_shm:
+        return "shm:" + address.path;
+    default:
+        if (address.host.find(':') != std::string::npos) {
+            return "[" + address.host + "]:" + std::to_string(address.port);
+        }
+        return address.host + ":" + std::to_string(address.port);
+    }
+}
+
+const char* transportName(TransportKind kind) {
+    switch (kind) {
+    case transport_unix:
+        return "Unix socket";
+    case transport_shm:
+        return "shared memory";
+    default:
+        return "TCP";
+    }
+}
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include "structs.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct TransportAddress {
+    TransportKind kind = transport_tcp;
+    std::string host; // tcp, IPv4/IPv6 literal or a name resolved at connect time
+    int port = MONADO_PORT; // tcp
+    std::string path; // unix socket path or shm object name
+};
+
+// "host[:port]", "[v6]:port", bare "v6", "unix:/path" or "shm:/name", returns -1 if malformed
+int parseTransportAddress(const std::string& address, int default_port, TransportAddress& result);
+std::string formatTransportAddress(const TransportAddress& address);
+const char* transportName(TransportKind kind);
+
+/* One way of moving frame bytes to the receiver. DataSender owns the framing, send policy and
+   reconnect backoff, a Transport only connects, writes what it is given and reports its state. */
+class Transport {
+public:
+    virtual ~Transport() = default;
+    virtual int open(const TransportAddress& address, int connect_timeout_ms) = 0; // starts connecting, -1 if retrying cannot help
+    virtual ConnectionState update(void) = 0; // conn_connecting, conn_connected or conn_disconnected after a failure
+    virtual int write(const void* buf, size_t len) = 0; // bytes written, 0 if nothing could be, -1 on error
+    virtual bool isWriting(void) = 0; // bytes were handed over and write() has to be called again for the result
+    virtual int flush(int timeout_ms) = 0; // waits until write() can make progress, 0 on timeout
+    virtual int getBacklog(void) = 0; // bytes written but not consumed by the receiver yet
+    virtual uint64_t getSyscalls(void) = 0; // made by the write path
+    virtual int getFd(void) = 0; // connected socket, -1 if there is none
+    virtual int getPollFd(uint32_t& events) = 0; // fd to wait on while write() cannot progress, -1 if none
+    virtual std::string describe(void) = 0; // for the connect message
+    virtual const std::string& getError(void) = 0; // why update() or write() failed
+    virtual void close(void) = 0;
+};
+
+#endif // TRANSPORT_H
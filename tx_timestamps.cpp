@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "tx_timestamps.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+uint64_t realtimeNs(void) {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+uint64_t monotonicNs(void) {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+TxTimestamper::TxTimestamper() {
+    sockfd = -1;
+    bytes = 0;
+    frames = {};
+    frame_count = 0;
+    syscalls = 0;
+}
+
+/* OPT_ID makes the kernel report the byte offset of the last byte of every send call */
+int TxTimestamper::enable(int fd) {
+    unsigned flags = SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_TX_SOFTWARE
+                     | SOF_TIMESTAMPING_TX_ACK | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0) {
+        std::cerr << "TX timestamping is not supported: " << strerror(errno) << std::endl;
+        sockfd = -1;
+        return -1;
+    }
+    sockfd = fd;
+    bytes = 0;
+    frame_count = 0;
+    return 0;
+}
+
+void TxTimestamper::disable(void) {
+    sockfd = -1;
+}
+
+bool TxTimestamper::isEnabled(void) {
+    return sockfd >= 0;
+}
+
+void TxTimestamper::addBytes(size_t count) {
+    bytes += static_cast<uint32_t>(count);
+}
+
+void TxTimestamper::frameWritten(uint64_t submit_ns, uint64_t write_ns) {
+    if (!isEnabled()) {
+        return;
+    }
+    FrameRecord& rec = frames[frame_count % frames.size()];
+    rec.end_key = bytes - 1;
+    rec.submit_ns = submit_ns;
+    rec.write_ns = write_ns;
+    rec.sched_ns = 0;
+    frame_count++;
+}
+
+/* Keys only grow, so the match is almost always one of the newest records */
+TxTimestamper::FrameRecord* TxTimestamper::findFrame(uint32_t key) {
+    size_t n = std::min<uint64_t>(frame_count, frames.size());
+    for (size_t i = 1; i <= n; i++) {
+        FrameRecord& rec = frames[(frame_count - i) % frames.size()];
+        if (rec.end_key == key) {
+            return &rec;
+        }
+    }
+    return nullptr; // timestamp of a short write, or the frame already left the ring
+}
+
+void TxTimestamper::handleTimestamp(uint32_t key, uint32_t type, uint64_t ts_ns) {
+    FrameRecord* rec = findFrame(key);
+    if (!rec) {
+        return;
+    }
+    switch (type) {
+    case SCM_TSTAMP_SCHED:
+        rec->sched_ns = ts_ns;
+        stack_hist.record(ts_ns > rec->write_ns ? ts_ns - rec->write_ns : 0);
+        break;
+    case SCM_TSTAMP_SND:
+        user_hist.record(rec->write_ns > rec->submit_ns ? rec->write_ns - rec->submit_ns : 0);
+        if (rec->sched_ns) {
+            qdisc_hist.record(ts_ns > rec->sched_ns ? ts_ns - rec->sched_ns : 0);
+        }
+        total_hist.record(ts_ns > rec->submit_ns ? ts_ns - rec->submit_ns : 0);
+        break;
+    case SCM_TSTAMP_ACK:
+        ack_hist.record(ts_ns > rec->write_ns ? ts_ns - rec->write_ns : 0);
+        break;
+    }
+}
+
+/* Drains the error queue, returns the number of timestamps read */
+int TxTimestamper::collect(void) {
+    if (!isEnabled()) {
+        return 0;
+    }
+    int found = 0;
+    while (true) {
+        char control[256];
+        msghdr msg{};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        syscalls++;
+        if (recvmsg(sockfd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            break; // EAGAIN, queue is empty
+        }
+        uint64_t ts_ns = 0;
+        const sock_extended_err* serr = nullptr;
+        for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPING) {
+                const scm_timestamping* tss = reinterpret_cast<const scm_timestamping*>(CMSG_DATA(cm));
+                ts_ns = static_cast<uint64_t>(tss->ts[0].tv_sec) * 1000000000ULL + tss->ts[0].tv_nsec;
+            } else if ((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR)
+                       || (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+                serr = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cm));
+            }
+        }
+        if (serr && serr->ee_origin == SO_EE_ORIGIN_TIMESTAMPING && ts_ns) {
+            handleTimestamp(serr->ee_data, serr->ee_info, ts_ns);
+            found++;
+        }
+    }
+    return found;
+}
+
+uint64_t TxTimestamper::getSyscalls(void) {
+    return syscalls;
+}
+
+TxLatencyStats TxTimestamper::getStats(void) {
+    TxLatencyStats s;
+    s.enabled = isEnabled();
+    s.user = user_hist.getSummary();
+    s.stack = stack_hist.getSummary();
+    s.qdisc = qdisc_hist.getSummary();
+    s.total = total_hist.getSummary();
+    s.ack = ack_hist.getSummary();
+    return s;
+}
+
+void TxTimestamper::reset(void) {
+    user_hist.reset();
+    stack_hist.reset();
+    qdisc_hist.reset();
+    total_hist.reset();
+    ack_hist.reset();
+}
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef TX_TIMESTAMPS_H
+#define TX_TIMESTAMPS_H
+
+#include "structs.h"
+#include "latency_histogram.h"
+
+#include <array>
+#include <cstdint>
+
+uint64_t realtimeNs(void); // CLOCK_REALTIME, the clock of kernel software timestamps
+uint64_t monotonicNs(void); // CLOCK_MONOTONIC, for intervals and deadlines
+
+// Collects SO_TIMESTAMPING software TX timestamps from the socket error queue and matches them to frames
+class TxTimestamper {
+    struct FrameRecord {
+        uint32_t end_key; // OPT_ID of the frame's last byte
+        uint64_t submit_ns; // handed to DataSender::sendData
+        uint64_t write_ns; // first byte written to the socket
+        uint64_t sched_ns; // entered the packet scheduler, 0 if not seen yet
+    };
+    int sockfd;
+    uint32_t bytes; // bytes written since enable(), OPT_ID counts the same way
+    std::array<FrameRecord, 512> frames; // ring of recently written frames
+    uint64_t frame_count;
+    uint64_t syscalls;
+    LatencyHistogram user_hist;
+    LatencyHistogram stack_hist;
+    LatencyHistogram qdisc_hist;
+    LatencyHistogram total_hist;
+    LatencyHistogram ack_hist;
+
+    FrameRecord* findFrame(uint32_t key);
+    void handleTimestamp(uint32_t key, uint32_t type, uint64_t ts_ns);
+public:
+    TxTimestamper();
+    int enable(int fd);
+    void disable(void);
+    bool isEnabled(void);
+    void addBytes(size_t count);
+    void frameWritten(uint64_t submit_ns, uint64_t write_ns);
+    int collect(void);
+    uint64_t getSyscalls(void);
+    TxLatencyStats getStats(void);
+    void reset(void);
+};
+
+#endif // TX_TIMESTAMPS_H
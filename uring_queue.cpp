@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "uring_queue.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+UringQueue::UringQueue() {
+    ring_fd = -1;
+    sqpoll = false;
+    entries = 0;
+    sq_ptr = cq_ptr = nullptr;
+    sq_len = cq_len = 0;
+    sqes = nullptr;
+    sqes_len = 0;
+    sq_head = sq_tail = sq_mask = sq_flags = sq_array = nullptr;
+    cq_head = cq_tail = cq_mask = nullptr;
+    cqes = nullptr;
+    sqe_tail = 0;
+    to_submit = 0;
+    buffers = nullptr;
+    buffer_size = 0;
+    buffer_count = 0;
+    syscalls = 0;
+}
+
+UringQueue::~UringQueue() {
+    teardown();
+}
+
+/* Returns -1 if io_uring is not available (old kernel, seccomp, io_uring_disabled sysctl) */
+int UringQueue::setup(unsigned queue_entries, bool use_sqpoll) {
+    teardown();
+    io_uring_params params{};
+    if (use_sqpoll) {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = 1000; // ms before the kernel thread goes to sleep
+    }
+    ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_entries, &params));
+    if (ring_fd < 0) {
+        std::cerr << "io_uring setup failed: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    sqpoll = use_sqpoll;
+    entries = params.sq_entries;
+
+    sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_len = cq_len = std::max(sq_len, cq_len);
+    }
+    sq_ptr = mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED) {
+        sq_ptr = nullptr;
+        teardown();
+        return -1;
+    }
+    if (single_mmap) {
+        cq_ptr = sq_ptr;
+    } else {
+        cq_ptr = mmap(nullptr, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ptr == MAP_FAILED) {
+            cq_ptr = nullptr;
+            teardown();
+            return -1;
+        }
+    }
+    sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes_ptr = mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (sqes_ptr == MAP_FAILED) {
+        teardown();
+        return -1;
+    }
+    sqes = static_cast<io_uring_sqe*>(sqes_ptr);
+
+    char* sq = static_cast<char*>(sq_ptr);
+    sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_flags = reinterpret_cast<unsigned*>(sq + params.sq_off.flags);
+    sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(cq_ptr);
+    cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    sqe_tail = *sq_tail;
+    to_submit = 0;
+    return 0;
+}
+
+void UringQueue::teardown(void) {
+    if (buffers) {
+        munmap(buffers, buffer_size * buffer_count);
+        buffers = nullptr;
+        buffer_count = 0;
+    }
+    if (sqes) {
+        munmap(sqes, sqes_len);
+        sqes = nullptr;
+    }
+    if (cq_ptr && cq_ptr != sq_ptr) {
+        munmap(cq_ptr, cq_len);
+    }
+    cq_ptr = nullptr;
+    if (sq_ptr) {
+        munmap(sq_ptr, sq_len);
+        sq_ptr = nullptr;
+    }
+    if (ring_fd >= 0) {
+        close(ring_fd);
+        ring_fd = -1;
+    }
+}
+
+bool UringQueue::isReady(void) {
+    return ring_fd >= 0;
+}
+
+bool UringQueue::usesSqpoll(void) {
+    return sqpoll;
+}
+
+int UringQueue::getFd(void) {
+    return ring_fd;
+}
+
+/* Fixed buffers are pinned once, so the kernel skips the per-write page lookup */
+int UringQueue::registerBuffers(int count, size_t size) {
+    count = std::clamp(count, 1, 16);
+    void* mem = mmap(nullptr, size * count, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        return -1;
+    }
+    iovec iov[16];
+    for (int i = 0; i < count; i++) {
+        iov[i].iov_base = static_cast<char*>(mem) + i * size;
+        iov[i].iov_len = size;
+    }
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, iov, count) < 0) {
+        std::cerr << "io_uring buffer registration failed: " << strerror(errno) << std::endl;
+        munmap(mem, size * count);
+        return -1;
+    }
+    buffers = mem;
+    buffer_size = size;
+    buffer_count = count;
+    return 0;
+}
+
+void* UringQueue::getBuffer(int index) {
+    if (!buffers || index < 0 || index >= buffer_count) {
+        return nullptr;
+    }
+    return static_cast<char*>(buffers) + index * buffer_size;
+}
+
+io_uring_sqe* UringQueue::getSqe(void) {
+    unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    if (sqe_tail - head >= entries) {
+        return nullptr; // submission queue full
+    }
+    unsigned idx = sqe_tail & *sq_mask;
+    io_uring_sqe* sqe = &sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array[idx] = idx;
+    sqe_tail++;
+    to_submit++;
+    return sqe;
+}
+
+void UringQueue::prepConnect(io_uring_sqe* sqe, int fd, const sockaddr* addr, socklen_t addr_len, uint64_t user_data) {
+    sqe->opcode = IORING_OP_CONNECT;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(addr);
+    sqe->off = addr_len;
+    sqe->user_data = user_data;
+}
+
+void UringQueue::prepLinkTimeout(io_uring_sqe* sqe, const __kernel_timespec* ts, uint64_t user_data) {
+    sqe->opcode = IORING_OP_LINK_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(ts);
+    sqe->len = 1;
+    sqe->user_data = user_data;
+}
+
+void UringQueue::prepWriteFixed(io_uring_sqe* sqe, int fd, int buf_index, size_t offset, size_t len, uint64_t user_data) {
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(static_cast<char*>(getBuffer(buf_index)) + offset);
+    sqe->len = static_cast<uint32_t>(len);
+    sqe->off = static_cast<uint64_t>(-1); // sockets have no file position
+    sqe->buf_index = static_cast<uint16_t>(buf_index);
+    sqe->user_data = user_data;
+}
+
+int UringQueue::enter(unsigned submit, unsigned min_complete, unsigned flags) {
+    syscalls++;
+    int res = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, submit, min_complete, flags, nullptr, 0));
+    return res < 0 ? -errno : res;
+}
+
+/* With SQPOLL the kernel thread picks the entries up, a syscall is only needed to wake it */
+int UringQueue::submit(void) {
+    __atomic_store_n(sq_tail, sqe_tail, __ATOMIC_RELEASE);
+    unsigned count = to_submit;
+    to_submit = 0;
+    if (sqpoll) {
+        if (__atomic_load_n(sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_NEED_WAKEUP) {
+            return enter(count, 0, IORING_ENTER_SQ_WAKEUP);
+        }
+        return static_cast<int>(count);
+    }
+    if (count == 0) {
+        return 0;
+    }
+    return enter(count, 0, 0);
+}
+
+bool UringQueue::popCqe(io_uring_cqe& cqe) {
+    unsigned head = *cq_head;
+    if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    cqe = cqes[head & *cq_mask];
+    __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/* Waits until a completion is available; spins briefly first because SQPOLL completes within microseconds */
+int UringQueue::waitCqe(int timeout_ms) {
+    auto spin_end = std::chrono::steady_clock::now() + std::chrono::microseconds(20);
+    do {
+        if (*cq_head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+            return 1;
+        }
+    } while (std::chrono::steady_clock::now() < spin_end);
+    pollfd pfd {ring_fd, POLLIN, 0};
+    syscalls++;
+    return poll(&pfd, 1, timeout_ms);
+}
+
+uint64_t UringQueue::getSyscalls(void) {
+    return syscalls;
+}
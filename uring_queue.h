@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef URING_QUEUE_H
+#define URING_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+
+// Minimal io_uring wrapper (raw syscalls, no liburing) used by the DataSender io_uring backend
+class UringQueue {
+    int ring_fd;
+    bool sqpoll;
+    unsigned entries;
+
+    void* sq_ptr;
+    size_t sq_len;
+    void* cq_ptr;
+    size_t cq_len;
+    io_uring_sqe* sqes;
+    size_t sqes_len;
+
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_flags;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    io_uring_cqe* cqes;
+
+    unsigned sqe_tail; // local tail, published in submit()
+    unsigned to_submit;
+
+    void* buffers; // registered fixed buffers
+    size_t buffer_size;
+    int buffer_count;
+
+    uint64_t syscalls; // io_uring_enter and poll calls made so far
+
+    int enter(unsigned submit, unsigned min_complete, unsigned flags);
+public:
+    UringQueue();
+    ~UringQueue();
+    int setup(unsigned queue_entries, bool use_sqpoll);
+    void teardown(void);
+    bool isReady(void);
+    bool usesSqpoll(void);
+    int getFd(void);
+
+    int registerBuffers(int count, size_t size);
+    void* getBuffer(int index);
+
+    io_uring_sqe* getSqe(void);
+    void prepConnect(io_uring_sqe* sqe, int fd, const sockaddr* addr, socklen_t addr_len, uint64_t user_data);
+    void prepLinkTimeout(io_uring_sqe* sqe, const __kernel_timespec* ts, uint64_t user_data);
+    void prepWriteFixed(io_uring_sqe* sqe, int fd, int buf_index, size_t offset, size_t len, uint64_t user_data);
+    int submit(void);
+    bool popCqe(io_uring_cqe& cqe);
+    int waitCqe(int timeout_ms);
+    uint64_t getSyscalls(void);
+};
+
+#endif // URING_QUEUE_H
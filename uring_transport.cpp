@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "uring_transport.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/epoll.h>
+#include <fcntl.h>
+
+// io_uring completion tags, the upper bits of user_data hold the connection generation
+enum UringTag {
+    tag_connect = 1,
+    tag_timeout = 2,
+    tag_write = 3
+};
+
+static uint64_t uringUserData(uint64_t generation, UringTag tag) {
+    return (generation << 2) | tag;
+}
+
+UringTransport::UringTransport() {
+    buffer_size = 0;
+    generation = 0;
+    write_in_flight = false;
+}
+
+UringTransport::~UringTransport() {
+    close();
+}
+
+int UringTransport::setup(bool sqpoll, size_t max_frame_size) {
+    if (uring.setup(32, sqpoll) < 0 || uring.registerBuffers(1, max_frame_size) < 0) {
+        uring.teardown();
+        return -1;
+    }
+    buffer_size = max_frame_size;
+    return 0;
+}
+
+bool UringTransport::usesSqpoll(void) {
+    return uring.usesSqpoll();
+}
+
+/* io_uring waits for the socket itself, a blocking socket avoids -EAGAIN round trips */
+int UringTransport::connectOne(void) {
+    sockfd = socket(connect_addr.ss_family, SOCK_STREAM, 0);
+    if (sockfd < 0) {
+        std::cerr << "Socked creation failed!" << std::endl;
+        state = conn_disconnected;
+        return -1;
+    }
+    // connect linked with a timeout, the kernel cancels it when the timeout fires first
+    io_uring_sqe* conn_sqe = uring.getSqe();
+    io_uring_sqe* timeout_sqe = uring.getSqe();
+    if (!conn_sqe || !timeout_sqe) {
+        failed("io_uring submission queue full");
+        return 0;
+    }
+    uring.prepConnect(conn_sqe, sockfd, (sockaddr*)&connect_addr, connect_addr_len,
+                      uringUserData(generation, tag_connect));
+    conn_sqe->flags |= IOSQE_IO_LINK;
+    connect_ts.tv_sec = connect_timeout_ms / 1000;
+    connect_ts.tv_nsec = (connect_timeout_ms % 1000) * 1000000LL;
+    uring.prepLinkTimeout(timeout_sqe, &connect_ts, uringUserData(generation, tag_timeout));
+    int res = uring.submit();
+    if (res < 0) {
+        failed(strerror(-res));
+    }
+    return 0;
+}
+
+void UringTransport::pollConnect(void) {
+    reapCompletions();
+    // the linked timeout normally fires first, this only guards against a lost completion
+    if (state == conn_connecting && std::chrono::steady_clock::now() >= deadline + std::chrono::milliseconds(500)) {
+        failed("timeout");
+    }
+}
+
+/* A socket that won the happy eyeballs race was non-blocking */
+void UringTransport::connected(void) {
+    fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL) & ~O_NONBLOCK);
+    SocketTransport::connected();
+}
+
+/* Returns the bytes of a completed write, 0 if none completed, -1 on error */
+int UringTransport::reapCompletions(void) {
+    io_uring_cqe cqe;
+    int written = 0;
+    while (uring.popCqe(cqe)) {
+        if ((cqe.user_data >> 2) != generation) {
+            continue; // belongs to a socket that is already closed
+        }
+        switch (cqe.user_data & 3) {
+        case tag_connect:
+            if (state != conn_connecting) {
+                break;
+            }
+            if (cqe.res == 0) {
+                connected();
+                state = conn_connected;
+            } else {
+                failed(cqe.res == -ECANCELED ? "timeout" : strerror(-cqe.res));
+            }
+            break;
+        case tag_write:
+            write_in_flight = false;
+            if (cqe.res < 0) {
+                last_error = strerror(-cqe.res);
+                return -1;
+            }
+            written += cqe.res;
+            break;
+        default:
+            break;
+        }
+    }
+    return written;
+}
+
+/* One write from the registered buffer is in flight at a time, so frames can never interleave */
+int UringTransport::write(const void* buf, size_t len) {
+    if (!write_in_flight) {
+        if (len > buffer_size) {
+            last_error = "frame larger than the registered buffer";
+            return -1;
+        }
+        io_uring_sqe* sqe = uring.getSqe();
+        if (!sqe) {
+            return 0;
+        }
+        memcpy(uring.getBuffer(0), buf, len);
+        uring.prepWriteFixed(sqe, sockfd, 0, 0, len, uringUserData(generation, tag_write));
+        int res = uring.submit();
+        if (res < 0) {
+            last_error = strerror(-res);
+            return -1;
+        }
+        write_in_flight = true;
+    }
+    return reapCompletions();
+}
+
+bool UringTransport::isWriting(void) {
+    return write_in_flight;
+}
+
+int UringTransport::flush(int timeout_ms) {
+    return uring.waitCqe(timeout_ms);
+}
+
+uint64_t UringTransport::getSyscalls(void) {
+    return syscalls + uring.getSyscalls();
+}
+
+int UringTransport::getPollFd(uint32_t& events) {
+    if (state != conn_connected || !write_in_flight) {
+        return -1;
+    }
+    events = EPOLLIN; // the ring fd is readable when a completion is posted
+    return uring.getFd();
+}
+
+std::string UringTransport::describe(void) {
+    return SocketTransport::describe() + ", io_uring";
+}
+
+void UringTransport::close(void) {
+    SocketTransport::close();
+    generation++;
+    write_in_flight = false;
+}
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef URING_TRANSPORT_H
+#define URING_TRANSPORT_H
+
+#include "socket_transport.h"
+#include "uring_queue.h"
+
+// Same sockets and connection setup as SocketTransport, connect and writes go through io_uring
+class UringTransport : public SocketTransport {
+    UringQueue uring;
+    size_t buffer_size;
+    uint64_t generation; // tags completions, so results for an already closed socket are ignored
+    bool write_in_flight;
+    __kernel_timespec connect_ts{};
+
+    int reapCompletions(void);
+protected:
+    int connectOne(void) override;
+    void pollConnect(void) override;
+    void connected(void) override;
+public:
+    UringTransport();
+    ~UringTransport() override;
+    int setup(bool sqpoll, size_t max_frame_size); // -1 if io_uring cannot be used
+    bool usesSqpoll(void);
+    int write(const void* buf, size_t len) override;
+    bool isWriting(void) override;
+    int flush(int timeout_ms) override;
+    uint64_t getSyscalls(void) override;
+    int getPollFd(uint32_t& events) override;
+    std::string describe(void) override;
+    void close(void) override;
+};
+
+#endif // URING_TRANSPORT_H
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#include "wire_protocol.h"
+
+#include <cstring>
+#include <type_traits>
+
+/* Version 3 ("mndrmt3"), Monado src/xrt/drivers/remote/r_interface.h since e4931a46.
+   Offsets follow the padding comments there, a mismatch breaks the build instead of
+   showing up as garbage poses in monado-service. */
+namespace wire_v3 {
+
+static_assert(sizeof(float) == 4 && sizeof(bool) == 1, "Monado's layout assumes 4 byte floats and 1 byte bools");
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "frames are sent in host order, Monado runs on little endian");
+static_assert(std::is_trivially_copyable<r_remote_data>::value && std::is_standard_layout<r_remote_data>::value,
+              "r_remote_data is sent with memcpy/send");
+
+static_assert(sizeof(xrt_vec1) == 4 && sizeof(xrt_vec2) == 8 && sizeof(xrt_vec3) == 12, "vector size");
+static_assert(sizeof(xrt_quat) == 16 && sizeof(xrt_fov) == 16, "quat/fov size");
+static_assert(offsetof(xrt_pose, orientation) == 0 && offsetof(xrt_pose, position) == 16 && sizeof(xrt_pose) == 28,
+              "pose layout");
+
+using controller = r_remote_controller_data;
+static_assert(offsetof(controller, pose) == 0, "controller pose");
+static_assert(offsetof(controller, linear_velocity) == 28, "controller linear_velocity");
+static_assert(offsetof(controller, angular_velocity) == 40, "controller angular_velocity");
+static_assert(offsetof(controller, hand_curl) == 52, "controller hand_curl");
+static_assert(offsetof(controller, trigger_value) == 72, "controller trigger_value");
+static_assert(offsetof(controller, squeeze_value) == 76, "controller squeeze_value");
+static_assert(offsetof(controller, squeeze_force) == 80, "controller squeeze_force");
+static_assert(offsetof(controller, thumbstick) == 84, "controller thumbstick");
+static_assert(offsetof(controller, trackpad_force) == 92, "controller trackpad_force");
+static_assert(offsetof(controller, trackpad) == 96, "controller trackpad");
+static_assert(offsetof(controller, hand_tracking_active) == 104, "controller hand_tracking_active");
+static_assert(offsetof(controller, active) == 105, "controller active");
+static_assert(offsetof(controller, system_click) == 106, "controller system_click");
+static_assert(offsetof(controller, system_touch) == 107, "controller system_touch");
+static_assert(offsetof(controller, a_click) == 108, "controller a_click");
+static_assert(offsetof(controller, a_touch) == 109, "controller a_touch");
+static_assert(offsetof(controller, b_click) == 110, "controller b_click");
+static_assert(offsetof(controller, b_touch) == 111, "controller b_touch");
+static_assert(offsetof(controller, trigger_click) == 112, "controller trigger_click");
+static_assert(offsetof(controller, trigger_touch) == 113, "controller trigger_touch");
+static_assert(offsetof(controller, thumbstick_click) == 114, "controller thumbstick_click");
+static_assert(offsetof(controller, thumbstick_touch) == 115, "controller thumbstick_touch");
+static_assert(offsetof(controller, trackpad_touch) == 116, "controller trackpad_touch");
+static_assert(offsetof(controller, _pad0) == 117, "controller padding");
+static_assert(sizeof(controller) == 120, "active(2) + bools(11) + pad(3) = 16 after 104 bytes of values");
+
+using view = std::remove_reference<decltype(r_head_data::views[0])>::type;
+static_assert(offsetof(view, fov) == 0, "view fov");
+static_assert(offsetof(view, pose) == 16, "view pose");
+static_assert(offsetof(view, _pad) == 44, "view padding");
+static_assert(sizeof(view) == 48, "fov(16) + pose(16 + 12) + 4 = 48");
+static_assert(offsetof(r_head_data, views) == 0, "head views");
+static_assert(offsetof(r_head_data, center) == 96, "head center");
+static_assert(offsetof(r_head_data, per_view_data_valid) == 124, "head per_view_data_valid");
+static_assert(sizeof(r_head_data) == 128, "pose(16 + 12) bool(1) + pad(3) = 32 after the views");
+
+static_assert(offsetof(r_remote_data, header) == 0, "header");
+static_assert(offsetof(r_remote_data, head) == 8, "head");
+static_assert(offsetof(r_remote_data, left) == 136, "left controller");
+static_assert(offsetof(r_remote_data, right) == 256, "right controller");
+static_assert(sizeof(r_remote_data) == 376, "frame size");
+
+static size_t serialize(const r_remote_data& data, uint8_t* out) {
+    const uint64_t header = R_HEADER_VALUE;
+    memcpy(out, &data, sizeof(data));
+    memcpy(out, &header, sizeof(header));
+    return sizeof(data);
+}
+
+} // namespace wire_v3
+
+/* Version 2 ("mndrmt2"), Monado before e4931a46 added the per-view data: the head is only
+   the center pose. The controllers did not change, so their v3 asserts hold here too. */
+namespace wire_v2 {
+
+struct frame {
+    uint64_t header;
+    xrt_pose head_center;
+    r_remote_controller_data left, right;
+};
+
+static_assert(std::is_trivially_copyable<frame>::value && std::is_standard_layout<frame>::value, "frame is sent raw");
+static_assert(offsetof(frame, head_center) == 8, "head center");
+static_assert(offsetof(frame, left) == 36, "left controller");
+static_assert(offsetof(frame, right) == 156, "right controller");
+static_assert(sizeof(frame) == 280, "276 bytes of data, padded to the 8 byte alignment of the header");
+static_assert(sizeof(frame) <= max_wire_frame_size, "tx buffers are sized for the largest version");
+
+/* Frame stamps live in the head padding that v2 does not have, only the input id in the
+   right controller padding survives */
+static size_t serialize(const r_remote_data& data, uint8_t* out) {
+    frame f{};
+    f.header = R_HEADER_VALUE_V2;
+    f.head_center = data.head.center;
+    f.left = data.left;
+    f.right = data.right;
+    memcpy(out, &f, sizeof(f));
+    return sizeof(f);
+}
+
+} // namespace wire_v2
+
+/* Only layouts that can be checked field by field are listed, an older or newer Monado
+   needs its own struct with the same static_asserts and a serializer. The first entry is the default. */
+static const WireProtocol protocols[] = {
+    {3, "mndrmt3 (Monado since e4931a46)", R_HEADER_VALUE, sizeof(r_remote_data), true, wire_v3::serialize},
+    {2, "mndrmt2 (Monado before e4931a46)", R_HEADER_VALUE_V2, sizeof(wire_v2::frame), false, wire_v2::serialize},
+};
+
+const WireProtocol* findWireProtocol(int version) {
+    for (const auto& protocol : protocols) {
+        if (protocol.version == version) {
+            return &protocol;
+        }
+    }
+    return nullptr;
+}
+
+const WireProtocol* defaultWireProtocol(void) {
+    return &protocols[0];
+}
+
+size_t wireProtocolCount(void) {
+    return sizeof(protocols) / sizeof(protocols[0]);
+}
+
+const WireProtocol* wireProtocolAt(size_t index) {
+    return index < wireProtocolCount() ? &protocols[index] : nullptr;
+}
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: BSL-1.0
+/*!
+ * @author Adrian Przekwas <adrian.v.przekwas@gmail.com>
+ */
+
+#ifndef WIRE_PROTOCOL_H
+#define WIRE_PROTOCOL_H
+
+#include "structs.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// A version of Monado's remote driver protocol, the receiver checks header before anything else
+struct WireProtocol {
+    int version;
+    const char* name;
+    uint64_t header; // first 8 bytes of every frame
+    size_t frame_size; // bytes written by serialize
+    bool zero_copy; // frame is r_remote_data as is, the only layout the shared memory ring carries
+    size_t (*serialize)(const r_remote_data& data, uint8_t* out); // header included, returns frame_size
+};
+
+static const size_t max_wire_frame_size = sizeof(r_remote_data); // no version is larger than the current one
+
+const WireProtocol* findWireProtocol(int version); // nullptr if not supported
+const WireProtocol* defaultWireProtocol(void);
+size_t wireProtocolCount(void);
+const WireProtocol* wireProtocolAt(size_t index);
+
+#endif // WIRE_PROTOCOL_H